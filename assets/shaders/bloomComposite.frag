@@ -0,0 +1,13 @@
+#version 330
+out vec4 Frag_Colour;
+
+// First level of the bloom chain, added over the scene, see Bloom
+uniform sampler2D source;
+// Size of one target pixel in texture coordinates
+uniform vec2 targetTexel;
+uniform float intensity;
+
+void main(void)
+{
+	Frag_Colour = vec4(texture(source, gl_FragCoord.xy * targetTexel).rgb * intensity, 1.0);
+}
@@ -0,0 +1,21 @@
+#version 330
+out vec4 Frag_Colour;
+
+// Previous (larger) level of the bloom chain, see Bloom
+uniform sampler2D source;
+// Tap spacing in the source and the size of one target texel, in texture coordinates
+uniform vec2 sourceTexel;
+uniform vec2 targetTexel;
+
+void main(void)
+{
+	// 4 bilinear taps around the 2x2 source block, a 4x4 texel box
+	vec2 centre = gl_FragCoord.xy * targetTexel;
+	vec2 d = sourceTexel;
+	vec3 colour = 0.25 * (texture(source, centre + vec2(-d.x, -d.y)).rgb
+	                    + texture(source, centre + vec2( d.x, -d.y)).rgb
+	                    + texture(source, centre + vec2(-d.x,  d.y)).rgb
+	                    + texture(source, centre + vec2( d.x,  d.y)).rgb);
+
+	Frag_Colour = vec4(colour, 1.0);
+}
@@ -0,0 +1,31 @@
+#version 330
+out vec4 Frag_Colour;
+
+// The frame scaled down to the target size, see Bloom
+uniform sampler2D source;
+// Tap spacing in the source (half a texel) and the size of one target texel, in
+// texture coordinates
+uniform vec2 sourceTexel;
+uniform vec2 targetTexel;
+// Brightness where the glow starts and the width of its soft knee
+uniform float threshold;
+uniform float knee;
+
+void main(void)
+{
+	// 4 bilinear taps on texel corners, a slight blur against flicker
+	vec2 centre = gl_FragCoord.xy * targetTexel;
+	vec2 d = sourceTexel;
+	vec3 colour = 0.25 * (texture(source, centre + vec2(-d.x, -d.y)).rgb
+	                    + texture(source, centre + vec2( d.x, -d.y)).rgb
+	                    + texture(source, centre + vec2(-d.x,  d.y)).rgb
+	                    + texture(source, centre + vec2( d.x,  d.y)).rgb);
+
+	// Keeps what is brighter than the threshold, with a quadratic knee instead of a hard cut
+	float brightness = max(colour.r, max(colour.g, colour.b));
+	float soft = clamp(brightness - threshold + knee, 0.0, 2.0 * knee);
+	soft = soft * soft / (4.0 * knee + 0.00001);
+	float contribution = max(soft, brightness - threshold) / max(brightness, 0.00001);
+
+	Frag_Colour = vec4(colour * contribution, 1.0);
+}
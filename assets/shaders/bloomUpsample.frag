@@ -0,0 +1,23 @@
+#version 330
+out vec4 Frag_Colour;
+
+// Next (smaller) level of the bloom chain, added over the target, see Bloom
+uniform sampler2D source;
+// Size of one texel of the source and of the target, in texture coordinates
+uniform vec2 sourceTexel;
+uniform vec2 targetTexel;
+
+void main(void)
+{
+	// 3x3 tent [1 2 1] x [1 2 1] / 16
+	vec2 centre = gl_FragCoord.xy * targetTexel;
+	vec2 d = sourceTexel;
+
+	vec3 sum = texture(source, centre).rgb * 4.0;
+	sum += (texture(source, centre + vec2(-d.x, 0.0)).rgb + texture(source, centre + vec2(d.x, 0.0)).rgb
+	      + texture(source, centre + vec2(0.0, -d.y)).rgb + texture(source, centre + vec2(0.0, d.y)).rgb) * 2.0;
+	sum += texture(source, centre + vec2(-d.x, -d.y)).rgb + texture(source, centre + vec2(d.x, -d.y)).rgb
+	     + texture(source, centre + vec2(-d.x,  d.y)).rgb + texture(source, centre + vec2(d.x,  d.y)).rgb;
+
+	Frag_Colour = vec4(sum / 16.0, 1.0);
+}
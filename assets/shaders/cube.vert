@@ -1,11 +0,0 @@
-#version 330
-in vec3 position;
-
-uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projectionMatrix;
-
-void main(void)
-{
-	gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(position, 1.0);
-}
\ No newline at end of file
@@ -0,0 +1,10 @@
+// Frame uniform block, filled by FrameUniforms (keep both in sync)
+layout(std140) uniform Frame
+{
+	mat4  view;
+	mat4  projection;
+	mat4  viewProjection;
+	vec2  viewport;
+	float time;
+	float scale;
+};
@@ -0,0 +1,8 @@
+#version 330
+
+// One triangle covering the screen, no vertex buffer (positions from gl_VertexID)
+void main(void)
+{
+	vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+}
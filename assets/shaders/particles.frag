@@ -1,8 +1,7 @@
 #version 330
+in vec4 colour;
 out vec4 Frag_Colour;
 
-uniform vec4 colour;
-
 void main(void)
 {
 	Frag_Colour = colour;
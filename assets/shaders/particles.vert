@@ -0,0 +1,35 @@
+#version 330
+in vec2  position;
+in float life;
+in float seed;
+
+out vec4 colour;
+
+// Shared per frame uniforms, see FrameUniforms
+#include "frame.glsl"
+
+// Colour LUT, position = offset + byIndex * seed + byMagnitude * remaining life
+uniform sampler1D palette;
+uniform vec3 paletteMapping;
+
+uniform float lifetime;
+uniform float size;
+
+// Screen pixels (origin top left) to clip space
+vec4 screenToClip(vec2 p)
+{
+	return vec4(p / viewport * vec2(2.0, -2.0) + vec2(-1.0, 1.0), 0.0, 1.0);
+}
+
+void main(void)
+{
+	float remaining = clamp(life / lifetime, 0.0, 1.0);
+
+	float t = paletteMapping.x + paletteMapping.y * seed + paletteMapping.z * remaining;
+	colour = texture(palette, clamp(t, 0.0, 1.0));
+	colour.a *= remaining;
+
+	// Dead particles are moved outside the clip volume
+	gl_Position  = life > 0.0 ? screenToClip(position) : vec4(2.0, 2.0, 2.0, 1.0);
+	gl_PointSize = size * scale;
+}
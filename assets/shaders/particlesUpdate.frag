@@ -0,0 +1,6 @@
+#version 330
+
+// Never runs, the update pass is drawn with GL_RASTERIZER_DISCARD
+void main(void)
+{
+}
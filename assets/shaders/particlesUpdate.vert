@@ -0,0 +1,76 @@
+#version 330
+in vec2  position;
+in vec2  velocity;
+in float life;
+in float seed;
+
+// Captured by transform feedback into the other particle buffer
+out vec2  outPosition;
+out vec2  outVelocity;
+out float outLife;
+out float outSeed;
+
+uniform float dt;
+uniform uint  frame;
+
+// Fraction of dead particles that respawn this step
+uniform float spawn;
+// Bass energy relative to its running average (0-2)
+uniform float energy;
+
+uniform vec2  emitter;
+uniform float speed;
+uniform float lifetime;
+uniform float swirl;
+
+const float TAU = 6.28318530718;
+
+uint hash(uint x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+float random(inout uint state)
+{
+	state = hash(state);
+	return float(state) / 4294967295.0;
+}
+
+void main(void)
+{
+	uint state = hash(uint(gl_VertexID) ^ hash(frame)) ^ floatBitsToUint(seed);
+
+	outSeed     = seed;
+	outPosition = position;
+	outVelocity = velocity;
+	outLife     = life - dt;
+
+	if (life <= 0.0)
+	{
+		outLife = 0.0;
+
+		// Respawn at the emitter with a random direction, harder on strong bass
+		if (random(state) < spawn)
+		{
+			float angle = random(state) * TAU;
+			float v     = speed * (0.3 + 0.7 * random(state)) * (0.5 + energy);
+			outPosition = emitter + vec2(random(state), random(state)) * 4.0 - 2.0;
+			outVelocity = vec2(cos(angle), sin(angle)) * v;
+			outLife     = lifetime * (0.5 + 0.5 * random(state));
+		}
+		return;
+	}
+
+	// Swirl around the emitter with the bass, slight drag
+	vec2 d = position - emitter;
+	float distance = length(d);
+	vec2 tangent = distance > 0.0 ? vec2(-d.y, d.x) / distance : vec2(0.0);
+	outVelocity += tangent * swirl * energy * length(velocity) * dt;
+	outVelocity *= 1.0 - 0.5 * dt;
+	outPosition += outVelocity * dt;
+}
@@ -0,0 +1,65 @@
+#version 330
+out vec4 Frag_Colour;
+
+// Rendered frame, GL orientation (bottom row first), linear filtering
+uniform sampler2D source;
+// Video size in pixels, width a multiple of 8 and height even
+uniform ivec2 size;
+
+// The target is width / 4 texels wide and height * 3 / 2 rows high. Read back as bytes
+// and flipped it is exactly one Y4M 4:2:0 frame: height rows of Y, then the U and V
+// planes with two of their half width rows packed into every target row. A texel
+// holds 4 neighbouring bytes of one row, so it never straddles two planes.
+
+// BT.709 limited range
+const vec3 LUMA = vec3(0.2126, 0.7152, 0.0722);
+
+vec3 pixel(int x, int y)
+{
+	// Top left origin like the video
+	return texelFetch(source, ivec2(x, size.y - 1 - y), 0).rgb;
+}
+
+float luma(vec3 rgb)
+{
+	return (16.0 + 219.0 * dot(rgb, LUMA)) / 255.0;
+}
+
+float chroma(int x, int y, bool red)
+{
+	// Sampling the corner shared by the 2x2 block averages it (centred chroma, C420jpeg)
+	vec2 corner = vec2(2 * x + 1, size.y - 1 - 2 * y);
+	vec3 rgb = texture(source, corner / vec2(size)).rgb;
+
+	float y709 = dot(rgb, LUMA);
+	float difference = red ? (rgb.r - y709) / 1.5748 : (rgb.b - y709) / 1.8556;
+	return (128.0 + 224.0 * difference) / 255.0;
+}
+
+void main(void)
+{
+	// Rows are flipped back by the readback
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	int row = size.y * 3 / 2 - 1 - texel.y;
+	int x   = texel.x * 4;
+
+	if (row < size.y)
+	{
+		Frag_Colour = vec4(luma(pixel(x, row)), luma(pixel(x + 1, row)), luma(pixel(x + 2, row)), luma(pixel(x + 3, row)));
+		return;
+	}
+
+	// Half width chroma rows, U for the first half of them and V after
+	int halfWidth = size.x / 2;
+	int line = (row - size.y) * 2;
+	if (x >= halfWidth)
+	{
+		x    -= halfWidth;
+		line += 1;
+	}
+	bool red = line >= size.y / 2;
+	if (red)
+		line -= size.y / 2;
+
+	Frag_Colour = vec4(chroma(x, line, red), chroma(x + 1, line, red), chroma(x + 2, line, red), chroma(x + 3, line, red));
+}
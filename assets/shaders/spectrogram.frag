@@ -0,0 +1,29 @@
+#version 330
+in vec2 uv;
+out vec4 Frag_Colour;
+
+// One spectrum per row, head is the newest row (the texture wraps in t)
+uniform sampler2D history;
+uniform int head;
+
+// Colour LUT, position = offset + byIndex * frequency position + byMagnitude * level
+uniform sampler1D palette;
+uniform vec3 paletteMapping;
+
+// dB shown between the bottom and the top of the palette
+uniform float range;
+
+void main(void)
+{
+	// Newest column on the right, low frequencies at the bottom
+	float rows = float(textureSize(history, 0).y);
+	float age  = (1.0 - uv.x) * (rows - 1.0);
+	float t    = (float(head) - age + 0.5) / rows;
+	float frequency = 1.0 - uv.y;
+
+	float magnitude = texture(history, vec2(frequency, t)).r;
+	float level = clamp(1.0 + 20.0 * log(max(magnitude, 1e-9)) / log(10.0) / range, 0.0, 1.0);
+
+	float c = paletteMapping.x + paletteMapping.y * frequency + paletteMapping.z * level;
+	Frag_Colour = texture(palette, clamp(c, 0.0, 1.0));
+}
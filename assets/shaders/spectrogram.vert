@@ -0,0 +1,25 @@
+#version 330
+
+out vec2 uv;
+
+// Shared per frame uniforms, see FrameUniforms
+#include "frame.glsl"
+
+// Screen rectangle in pixels (origin top left)
+uniform vec2 rectPosition;
+uniform vec2 rectSize;
+
+// Screen pixels (origin top left) to clip space
+vec4 screenToClip(vec2 p)
+{
+	return vec4(p / viewport * vec2(2.0, -2.0) + vec2(-1.0, 1.0), 0.0, 1.0);
+}
+
+// Two triangles from gl_VertexID, no vertex buffer
+void main(void)
+{
+	const vec2 corners[6] = vec2[](vec2(0, 0), vec2(1, 0), vec2(0, 1), vec2(0, 1), vec2(1, 0), vec2(1, 1));
+	uv = corners[gl_VertexID];
+
+	gl_Position = screenToClip(rectPosition + uv * rectSize);
+}
@@ -1,8 +1,7 @@
 #version 330
+in vec4 colour;
 out vec4 frag_colour;
 
-uniform vec4 colour;
-
 void main(void)
 {
 	frag_colour = colour;
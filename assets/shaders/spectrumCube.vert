@@ -0,0 +1,32 @@
+#version 330
+in vec3 position;
+
+out vec4 colour;
+
+// Shared per frame uniforms, see FrameUniforms
+#include "frame.glsl"
+
+uniform sampler1D spectrum;
+
+// Colour LUT, position = offset + byIndex * index / count + byMagnitude * magnitude
+uniform sampler1D palette;
+uniform vec3 paletteMapping;
+
+uniform float radius;
+uniform float startAngle;
+uniform float angleStep;
+uniform float amplitude;
+
+void main(void)
+{
+	float magnitude = texelFetch(spectrum, gl_InstanceID, 0).r;
+	float a = radians(startAngle + gl_InstanceID * angleStep);
+
+	// Unit cube scaled to the bar height and moved onto the arc
+	vec3 p = position * vec3(1.0, magnitude * amplitude, 1.0) + vec3(radius * cos(a), 0.0, radius * sin(a));
+
+	float t = paletteMapping.x + paletteMapping.y * gl_InstanceID / float(textureSize(spectrum, 0)) + paletteMapping.z * magnitude;
+	colour = texture(palette, clamp(t, 0.0, 1.0));
+
+	gl_Position = viewProjection * vec4(p, 1.0);
+}
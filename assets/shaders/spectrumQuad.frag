@@ -0,0 +1,8 @@
+#version 330
+in vec4 colour;
+out vec4 Frag_Colour;
+
+void main(void)
+{
+	Frag_Colour = colour;
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#version 330
+in vec2 position;
+
+out vec4 colour;
+
+// Shared per frame uniforms, see FrameUniforms
+#include "frame.glsl"
+
+uniform sampler1D spectrum;
+
+// Colour LUT, position = offset + byIndex * index / count + byMagnitude * magnitude
+uniform sampler1D palette;
+uniform vec3 paletteMapping;
+
+uniform vec2  origin;
+uniform float barWidth;
+uniform float amplitude;
+
+// Circle layout (loadBool uploads a float)
+uniform float circular;
+uniform float radius;
+uniform float angleStep;
+
+// Screen pixels (origin top left) to clip space
+vec4 screenToClip(vec2 p)
+{
+	return vec4(p / viewport * vec2(2.0, -2.0) + vec2(-1.0, 1.0), 0.0, 1.0);
+}
+
+void main(void)
+{
+	float magnitude = texelFetch(spectrum, gl_InstanceID, 0).r;
+	vec2 size = vec2(barWidth, -magnitude * amplitude);
+
+	// Bars are placed side by side, circle bars around the centre pointing outwards
+	vec2  barPosition = origin + vec2(gl_InstanceID * barWidth, 0.0);
+	float rotation    = 0.0;
+	if (circular > 0.5)
+	{
+		float a = radians(gl_InstanceID * angleStep);
+		barPosition = origin + radius * vec2(cos(a), sin(a));
+		rotation    = a + radians(90.0);
+	}
+
+	// Scale, rotate around the position, translate
+	vec2 p = position * size;
+	p = vec2(p.x * cos(rotation) - p.y * sin(rotation), p.x * sin(rotation) + p.y * cos(rotation));
+
+	float t = paletteMapping.x + paletteMapping.y * gl_InstanceID / float(textureSize(spectrum, 0)) + paletteMapping.z * magnitude;
+	colour = texture(palette, clamp(t, 0.0, 1.0));
+
+	gl_Position = screenToClip(p + barPosition);
+}
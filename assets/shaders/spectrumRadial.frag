@@ -0,0 +1,89 @@
+#version 330
+out vec4 Frag_Colour;
+
+// Shared per frame uniforms, see FrameUniforms
+#include "frame.glsl"
+
+uniform sampler1D spectrum;
+
+// Colour LUT, position = offset + byIndex * index / count + byMagnitude * magnitude
+uniform sampler1D palette;
+uniform vec3 paletteMapping;
+
+// Screen pixels, origin top left like the quad renderers
+uniform vec2  centre;
+uniform float radius;
+uniform float barWidth;
+uniform float amplitude;
+uniform float ringWidth;
+uniform float glow;
+
+const float TAU = 6.28318530718;
+
+// Distance to a bar pointing outwards from the circle, in pixels (negative inside)
+float barDistance(vec2 polar, int index, float step, out float magnitude)
+{
+	int count = textureSize(spectrum, 0);
+	magnitude = texelFetch(spectrum, (index + count) % count, 0).r;
+	float height = magnitude * amplitude;
+
+	// Local frame of the bar: x across (tangent), y along the bar from the circle
+	float da = polar.y - float(index) * step;
+	vec2 local = vec2(polar.x * sin(da), polar.x * cos(da) - radius);
+
+	// Box from (-w/2, 0) to (w/2, height)
+	vec2 q = abs(local - vec2(0.0, height * 0.5)) - vec2(barWidth, height) * 0.5;
+	return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0);
+}
+
+vec4 paletteColour(int index, float magnitude)
+{
+	float t = paletteMapping.x + paletteMapping.y * index / float(textureSize(spectrum, 0)) + paletteMapping.z * magnitude;
+	return texture(palette, clamp(t, 0.0, 1.0));
+}
+
+void main(void)
+{
+	int count = textureSize(spectrum, 0);
+	float step = TAU / float(count);
+
+	// Pixel in polar coordinates around the centre (y down like the screen), the
+	// target can be smaller than the screen (dynamic resolution)
+	vec2  pixel = gl_FragCoord.xy / scale;
+	vec2  d = vec2(pixel.x, viewport.y - pixel.y) - centre;
+	float angle = atan(d.y, d.x);
+	if (angle < 0.0)
+		angle += TAU;
+	vec2 polar = vec2(length(d), angle);
+
+	// Nearest bar and its neighbours, so wide bars near the centre still overlap correctly
+	int nearest = int(floor(angle / step + 0.5));
+	float dist = 1e9;
+	float magnitude = 0.0;
+	int index = nearest;
+	for (int i = -1; i <= 1; i++)
+	{
+		float m;
+		float bd = barDistance(polar, nearest + i, step, m);
+		if (bd < dist)
+		{
+			dist = bd;
+			magnitude = m;
+			index = (nearest + i + count) % count;
+		}
+	}
+
+	float ring = abs(polar.x - radius) - ringWidth * 0.5;
+	dist = min(dist, ring);
+
+	// 1 target pixel wide anti-aliased edge, glow falls off outside the shape
+	vec4  colour = paletteColour(index, magnitude);
+	float cover  = clamp(0.5 - dist * scale, 0.0, 1.0);
+	float halo   = glow > 0.0 ? exp(-max(dist, 0.0) / glow) * 0.5 : 0.0;
+
+	float alpha = max(cover, halo) * colour.a;
+	if (alpha < 1.0 / 255.0)
+		discard;
+
+	Frag_Colour = vec4(colour.rgb, alpha);
+}
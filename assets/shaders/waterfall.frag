@@ -0,0 +1,8 @@
+#version 330
+in vec4 colour;
+out vec4 frag_colour;
+
+void main(void)
+{
+	frag_colour = colour;
+}
\ No newline at end of file
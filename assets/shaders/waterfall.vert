@@ -0,0 +1,35 @@
+#version 330
+in vec2 position;
+
+out vec4 colour;
+
+// Shared per frame uniforms, see FrameUniforms
+#include "frame.glsl"
+
+// One spectrum per row, head is the newest row (the texture wraps in t)
+uniform sampler2D history;
+uniform int head;
+
+// Colour LUT, position = offset + byIndex * u + byMagnitude * magnitude
+uniform sampler1D palette;
+uniform vec3 paletteMapping;
+
+uniform mat4 model;
+uniform vec3 size;
+
+void main(void)
+{
+	// position.y is the age of the row, read backwards from head
+	float rows = float(textureSize(history, 0).y);
+	float t = (float(head) - position.y * (rows - 1.0) + 0.5) / rows;
+	float magnitude = texture(history, vec2(position.x, t)).r;
+
+	vec3 p = vec3(position.x - 0.5, magnitude, position.y - 0.5) * size;
+
+	float c = paletteMapping.x + paletteMapping.y * position.x + paletteMapping.z * magnitude;
+	colour = texture(palette, clamp(c, 0.0, 1.0));
+	// Older rows fade out
+	colour.rgb *= 1.0 - 0.75 * position.y;
+
+	gl_Position = viewProjection * model * vec4(p, 1.0);
+}
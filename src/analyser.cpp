@@ -0,0 +1,127 @@
+#include "analyser.h"
+
+#include <bass.h>
+#include <cmath>
+
+#include "audio/audioBackend.h"
+
+Analyser::Analyser(const nlohmann::json& config)
+    : m_plan(nullptr)
+    , m_silentTime(0.0f)
+    , m_silent(false)
+{
+    auto data = config["data"];
+    m_freqBins = data["freq_bin"].get<std::vector<float>>();
+
+    // BASS supports FFT sizes from 256 to 32768
+    m_fftSize = data.value("fftSize", 16384);
+    if (m_fftSize < 256 || m_fftSize > 32768 || (m_fftSize & (m_fftSize - 1)) != 0)
+    {
+        printf("Unsupported fftSize %d, using 16384\n", m_fftSize);
+        m_fftSize = 16384;
+    }
+
+    m_fft.resize(m_fftSize / 2);
+
+    // RMS below threshold (0.0005 is about -66 dBFS) for hold seconds counts as silence
+    auto silence = data.value("silence", nlohmann::json::object());
+    m_silenceThreshold = silence.value("threshold", 0.0005f);
+    m_silenceHold      = silence.value("hold", 0.5f);
+    m_tap.resize(silence.value("tapSize", 2048));
+}
+
+const std::vector<float>& Analyser::analyse(AudioBackend& audio, float elapsed)
+{
+    m_plan = &getPlan(audio.getSampleRate());
+
+    updateSilenceGate(audio, elapsed);
+    if (m_silent)
+    {
+        m_spectrum.assign(m_plan->bins.size(), 0.0f);
+        return m_spectrum;
+    }
+
+    audio.getFFT(m_fft.data(), m_plan->fftFlag);
+
+    m_spectrum.resize(m_plan->bins.size());
+    for (size_t i = 0; i < m_plan->bins.size(); i++)
+        m_spectrum[i] = m_fft[m_plan->bins[i]];
+
+    return m_spectrum;
+}
+
+const AnalysisPlan& Analyser::getPlan(int sampleRate)
+{
+    auto key = std::make_pair(sampleRate, m_fftSize);
+
+    auto it = m_plans.find(key);
+    if (it == m_plans.end())
+        it = m_plans.emplace(key, createPlan(sampleRate)).first;
+
+    return it->second;
+}
+
+bool Analyser::isSilent() const
+{
+    return m_silent;
+}
+
+float Analyser::getLatency() const
+{
+    if (!m_plan)
+        return 0.0f;
+
+    return (m_plan->fftSize / 2) / (float)m_plan->sampleRate;
+}
+
+void Analyser::updateSilenceGate(AudioBackend& audio, float elapsed)
+{
+    if (audio.isPaused())
+    {
+        m_silent = true;
+        return;
+    }
+
+    int count = audio.getSamples(m_tap.data(), (int)m_tap.size());
+
+    float sum = 0.0f;
+    for (int i = 0; i < count; i++)
+        sum += m_tap[i] * m_tap[i];
+    float rms = count > 0 ? std::sqrt(sum / count) : 0.0f;
+
+    // Leave silence immediately, enter it only after the hold time
+    if (rms >= m_silenceThreshold)
+        m_silentTime = 0.0f;
+    else
+        m_silentTime += elapsed;
+
+    m_silent = m_silentTime >= m_silenceHold;
+}
+
+AnalysisPlan Analyser::createPlan(int sampleRate)
+{
+    AnalysisPlan plan;
+    plan.sampleRate = sampleRate;
+    plan.fftSize    = m_fftSize;
+
+    // BASS_DATA_FFT256 is 0x80000000, every next flag doubles the size
+    plan.fftFlag = BASS_DATA_FFT256 + (unsigned long)std::log2(m_fftSize / 256);
+
+    // Get only the bins that have a frequency between the values in freq_bin
+    // using the formula:
+    //           freq = bin_count * sampleRate / N
+    //
+    // Source: https://stackoverflow.com/questions/4364823/how-do-i-obtain-the-frequencies-of-each-value-in-an-fft/4371627#4371627
+    for (int i = 0; i < m_fftSize / 2; i++)
+    {
+        float freq = (float)i * sampleRate / m_fftSize;
+        for (size_t j = 0; j + 1 < m_freqBins.size(); j++)
+        {
+            if ((freq > m_freqBins[j]) && (freq <= m_freqBins[j + 1]))
+                plan.bins.push_back(i);
+        }
+    }
+
+    printf("Created analysis plan: %d Hz, %d point FFT, %d bands\n", sampleRate, m_fftSize, (int)plan.bins.size());
+    return plan;
+}
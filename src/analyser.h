@@ -0,0 +1,63 @@
+#ifndef ANALYSER_H
+#define ANALYSER_H
+
+#include <vector>
+#include <map>
+#include <utility>
+
+#include "libs/json.hpp"
+
+class AudioBackend;
+
+// Precomputed mapping from FFT bins to the visualised bands for one stream sample rate
+struct AnalysisPlan
+{
+    int           sampleRate;
+    int           fftSize;
+    unsigned long fftFlag; // BASS_DATA_FFT* flag for fftSize
+
+    // FFT bins whose frequency falls inside the config freq_bin ranges
+    std::vector<int> bins;
+};
+
+class Analyser
+{
+public:
+    Analyser(const nlohmann::json& config);
+
+    // Runs the FFT on the current stream and returns the band magnitudes,
+    // the returned vector is reused every frame. While the stream is paused or
+    // silent the FFT is skipped and the magnitudes are zero.
+    const std::vector<float>& analyse(AudioBackend& audio, float elapsed);
+
+    // True once the sample tap RMS stayed below the threshold for the hold time (or the stream is paused)
+    bool isSilent() const;
+
+    // Plans are built on first use and cached by (sample rate, FFT size)
+    const AnalysisPlan& getPlan(int sampleRate);
+
+    // Delay of the FFT window center behind the newest sample in seconds
+    float getLatency() const;
+
+private:
+    int                m_fftSize;
+    std::vector<float> m_freqBins;
+
+    std::map<std::pair<int, int>, AnalysisPlan> m_plans;
+    const AnalysisPlan* m_plan;
+
+    std::vector<float> m_fft;
+    std::vector<float> m_spectrum;
+
+    // Silence gate
+    float m_silenceThreshold;
+    float m_silenceHold;
+    float m_silentTime;
+    bool  m_silent;
+    std::vector<float> m_tap;
+
+    AnalysisPlan createPlan(int sampleRate);
+    void updateSilenceGate(AudioBackend& audio, float elapsed);
+};
+
+#endif
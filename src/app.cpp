@@ -1,35 +1,126 @@
 #include "app.h"
 
 #include <cstdio>
+#include <vector>
+#include <algorithm>
 #include <glad/glad.h>
 
+#include "gl/glObjects.h"
+#include "headlessContext.h"
+#include "frameCapture.h"
+
 #define GLT_IMPLEMENTATION
 #include "libs/gltext.h"
 
 Clock::Clock()
 {
-    m_start = SDL_GetTicks();
+    m_start = SDL_GetPerformanceCounter();
 }
 
 // Returns elapsed time in seconds
 float Clock::restart()
 {
-    m_end = SDL_GetTicks();
-    float elapsed = (m_end - m_start) / 1000.0;
-    m_start = m_end;
+    Uint64 end = SDL_GetPerformanceCounter();
+    float elapsed = (float)((double)(end - m_start) / SDL_GetPerformanceFrequency());
+    m_start = end;
     return elapsed;
 }
 
+double Clock::elapsed() const
+{
+    return (double)(SDL_GetPerformanceCounter() - m_start) / SDL_GetPerformanceFrequency();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Spun stretch before the first sleep was measured, and its limits in seconds
+static const double INITIAL_SPIN = 0.002;
+static const double MIN_SPIN     = 0.0002;
+static const double MAX_SPIN     = 0.004;
+
+FramePacer::FramePacer()
+    : m_rate(0.0)
+    , m_frequency(SDL_GetPerformanceFrequency())
+    , m_period(0)
+    , m_deadline(0)
+    , m_spin((Uint64)(m_frequency * INITIAL_SPIN))
+{
+}
+
+void FramePacer::setRate(double fps)
+{
+    fps = fps > 0.0 ? fps : 0.0;
+    if (fps == m_rate)
+        return;
+
+    m_rate     = fps;
+    m_period   = fps > 0.0 ? (Uint64)(m_frequency / fps) : 0;
+    m_deadline = 0;
+}
+
+double FramePacer::getRate() const
+{
+    return m_rate;
+}
+
+void FramePacer::wait()
+{
+    if (m_period == 0)
+        return;
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (m_deadline == 0 || now > m_deadline + m_period)
+    {
+        m_deadline = now + m_period;
+        return;
+    }
+
+    // Sleep in whole milliseconds while a late wake-up still leaves time to spare
+    while (now + m_spin < m_deadline)
+    {
+        Uint32 ms = (Uint32)((m_deadline - m_spin - now) * 1000 / m_frequency);
+        if (ms == 0)
+            break;
+        SDL_Delay(ms);
+
+        // The spin covers the latest wake-ups seen and shrinks back slowly
+        Uint64 woke  = SDL_GetPerformanceCounter();
+        Uint64 asked = (Uint64)ms * m_frequency / 1000;
+        Uint64 late  = woke - now > asked ? woke - now - asked : 0;
+        m_spin = std::max(late + late / 4, m_spin - m_spin / 64);
+        m_spin = std::min(std::max(m_spin, (Uint64)(m_frequency * MIN_SPIN)), (Uint64)(m_frequency * MAX_SPIN));
+        now = woke;
+    }
+
+    while (now < m_deadline)
+        now = SDL_GetPerformanceCounter();
+
+    m_deadline += m_period;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-App::App(const char * title, int width, int height)
+App::App(const char * title, int width, int height, bool headless)
     : m_screenWidth(width)
     , m_screenHeight(height)
     , m_window(nullptr)
+    , m_maincontext(nullptr)
     , m_title(title)
     , m_bFPSCounter(true)
+    , m_bIdle(false)
+    , m_bSkipFrame(false)
+    , m_idleFPS(10)
+    , m_maxFPS(0)
+    , m_bVSync(false)
+    , m_swapInterval(0)
+    , m_bHeadless(headless)
+    , m_frameLimit(0)
+    , m_frameCount(0)
+    , m_fixedTimestep(0.0f)
+    , m_frameTime(0.0f)
 {
-    init_screen(title);
+    if (headless) init_headless();
+    else          init_screen(title);
 }
 
 App::~App()
@@ -38,9 +129,18 @@ App::~App()
     gltDeleteText(m_text);
     gltTerminate();
 
+    StopCapture();
+
+    // The offscreen target needs the context that is destroyed below
+    m_target.reset();
+    m_headless.reset();
+
     // Cleanup SDL2
-    SDL_DestroyWindow(m_window);
-    SDL_GL_DeleteContext(m_maincontext);
+    if (m_window)
+    {
+        SDL_DestroyWindow(m_window);
+        SDL_GL_DeleteContext(m_maincontext);
+    }
     SDL_Quit();
 }
 
@@ -55,6 +155,9 @@ void App::Run()
     if (!Setup())
         m_bQuit = true;
 
+    Clock runClock;
+    m_frameCount = 0;
+
     SDL_Event e;
     while (!m_bQuit)
     {
@@ -67,9 +170,8 @@ void App::Run()
                 // Resize the opengl viewport when the window size is changed
                 if (e.window.event == SDL_WINDOWEVENT_RESIZED)
                 {
-                    int width, height;
-                    SDL_GetWindowSize(m_window, &width, &height);
-                    glViewport(0, 0, width, height);
+                    SDL_GetWindowSize(m_window, &m_screenWidth, &m_screenHeight);
+                    glViewport(0, 0, m_screenWidth, m_screenHeight);
                 }
                 // Check for window focus
                 else if (e.window.event == SDL_WINDOWEVENT_FOCUS_GAINED) m_bFocus = true;
@@ -86,25 +188,71 @@ void App::Run()
                 m_bQuit = true;
         }
 
-        // Clear
-        glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+        // Without a window everything is drawn offscreen
+        if (m_target)
+            m_target->bind();
 
         // Run USER loop code
         float elapsed = m_clock.restart();
+        if (m_fixedTimestep > 0.0f)
+            elapsed = m_fixedTimestep;
+        m_bSkipFrame = false;
         if (!Loop(elapsed))
             m_bQuit = true;
 
+        // Wait for the frame to be due, idle displays drop to m_idleFPS so they don't peg a core
+        if (m_fixedTimestep <= 0.0f)
+        {
+            pace();
+            m_pacer.wait();
+        }
+
+        // Nothing new was drawn, keep showing the last frame
+        if (m_bSkipFrame)
+            continue;
+
+        // Queue the readback before presenting, it's collected a few frames later
+        if (m_capture)
+        {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, m_target ? m_target->fbo : 0);
+            if (m_target) m_capture->capture(m_target->width, m_target->height);
+            else          m_capture->capture(m_screenWidth, m_screenHeight);
+        }
+
         // Display
-        SDL_GL_SwapWindow(m_window);
+        if (m_window) SDL_GL_SwapWindow(m_window);
+        else          glFlush();
+        gl::StateCache::get().endFrame();
+
+        m_frameCount++;
+        if (m_frameLimit > 0 && m_frameCount >= m_frameLimit)
+            m_bQuit = true;
+
+        // Nobody sees a title when headless
+        if (!m_window)
+            continue;
 
         // FPS Counter Option
         if (m_bFPSCounter)
         {
-            std::string newTitle = m_title + " - FPS: " + std::to_string((1.0f / elapsed));
+            // Averaged, a single frame can take no measurable time
+            m_frameTime = m_frameTime > 0.0f ? m_frameTime * 0.95f + elapsed * 0.05f : elapsed;
+            float fps = m_frameTime > 0.0f ? 1.0f / m_frameTime : 0.0f;
+
+            const auto& calls = gl::StateCache::get().lastFrame();
+            std::string newTitle = m_title + " - FPS: " + std::to_string(fps)
+                + " - GL binds: " + std::to_string(calls.issued) + " issued, " + std::to_string(calls.elided) + " elided";
             SDL_SetWindowTitle(m_window, newTitle.c_str());
         }
         else SDL_SetWindowTitle(m_window, m_title.c_str());
     }
+
+    // Headless runs are benchmarks or renders, report how fast they went
+    if (m_bHeadless)
+    {
+        float seconds = (float)runClock.elapsed();
+        printf("Rendered %d frames in %.2fs (%.1f FPS)\n", m_frameCount, seconds, seconds > 0.0f ? m_frameCount / seconds : 0.0f);
+    }
 }
 
 void App::Quit()
@@ -145,16 +293,19 @@ void App::WireFrame(bool wireframe)
 
 void App::VSync(bool vsync)
 {
-    if (vsync) SDL_GL_SetSwapInterval(1);
-    else       SDL_GL_SetSwapInterval(0);
+    if (!m_window)
+        return;
+
+    m_bVSync = vsync;
+    m_swapInterval = vsync ? 1 : 0;
+    SDL_GL_SetSwapInterval(m_swapInterval);
 }
 
 // Culling should be Counter-Clock Wise
 // - glFrontFace(GL_CCW) by default but can be set to GL_CW
 void App::Culling(bool cull)
 {
-    if (cull) glEnable(GL_CULL_FACE);
-    else      glDisable(GL_CULL_FACE);
+    gl::StateCache::get().setEnabled(GL_CULL_FACE, cull);
 }
 
 void App::ShowCursor(bool cursor)
@@ -164,10 +315,92 @@ void App::ShowCursor(bool cursor)
 
 void App::Fullscreen(bool fullscreen)
 {
+    if (!m_window)
+        return;
+
     m_bIsFullscreen = fullscreen;
     SDL_SetWindowFullscreen(m_window, fullscreen);
 }
 
+void App::MaxFPS(int fps)
+{
+    m_maxFPS = fps > 0 ? fps : 0;
+}
+
+void App::Idle(bool idle)
+{
+    m_bIdle = idle;
+}
+
+void App::IdleFPS(int fps)
+{
+    m_idleFPS = fps > 0 ? fps : 1;
+}
+
+void App::SkipFrame()
+{
+    m_bSkipFrame = true;
+}
+
+void App::StartCapture(std::unique_ptr<FrameCapture> capture)
+{
+    StopCapture();
+    m_capture = std::move(capture);
+}
+
+void App::StopCapture()
+{
+    if (!m_capture)
+        return;
+
+    m_capture->finish();
+    printf("Captured %d frames\n", m_capture->getFrameCount());
+    m_capture.reset();
+}
+
+bool App::IsCapturing() const
+{
+    return m_capture != nullptr;
+}
+
+void App::FrameLimit(int frames)
+{
+    m_frameLimit = frames;
+}
+
+void App::FixedTimestep(float seconds)
+{
+    m_fixedTimestep = seconds;
+}
+
+bool App::SaveFrame(const std::string& path)
+{
+    if (!m_target)
+        return false;
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        printf("Could not open %s for writing\n", path.c_str());
+        return false;
+    }
+
+    std::vector<unsigned char> pixels((size_t)m_target->width * m_target->height * 3);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_target->fbo);
+    gl::StateCache::get().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, m_target->width, m_target->height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    // GL rows start at the bottom
+    fprintf(file, "P6\n%d %d\n255\n", m_target->width, m_target->height);
+    size_t rowBytes = (size_t)m_target->width * 3;
+    for (int y = m_target->height - 1; y >= 0; y--)
+        fwrite(pixels.data() + y * rowBytes, 1, rowBytes, file);
+    fclose(file);
+    return true;
+}
+
 /**
  *  Used as a mask when testing buttons in buttonstate.
  *   - SDL_BUTTON_LEFT    Left mouse button
@@ -217,22 +450,84 @@ void App::init_screen(const char * title)
     if (m_maincontext == nullptr)
         sdl_die("Failed to create OpenGL context");
 
+    gladLoadGLLoader(SDL_GL_GetProcAddress);
+    init_gl(SDL_GL_GetProcAddress);
+}
+
+void App::init_headless()
+{
+    // Timers and events still come from SDL, there just isn't a window
+    if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) < 0)
+        sdl_die("Couldn't initialize SDL");
+
+    m_headless = std::make_unique<HeadlessContext>();
+    if (!m_headless->create())
+        sdl_die("Failed to create headless OpenGL context");
+
+    gladLoadGLLoader(HeadlessContext::getProcAddress);
+    init_gl(HeadlessContext::getProcAddress);
+
+    m_bFocus = false;
+    m_bIsFullscreen = false;
+    m_target = std::make_unique<gl::Framebuffer>(m_screenWidth, m_screenHeight);
+    m_target->bind();
+}
+
+void App::init_gl(void* (*loader)(const char*))
+{
     // Check OpenGL properties
     printf("[OpenGL loaded]\n");
-    gladLoadGLLoader(SDL_GL_GetProcAddress);
     printf("Vendor:   %s\n", glGetString(GL_VENDOR));
     printf("Renderer: %s\n", glGetString(GL_RENDERER));
     printf("Version:  %s\n", glGetString(GL_VERSION));
     printf("\n");
 
+    // Linked shader programs are kept between runs in the user's data folder
+    char* prefPath = SDL_GetPrefPath("VisualiserGL", "shaders");
+    gl::ProgramCache::get().enable(prefPath ? prefPath : "", loader);
+    SDL_free(prefPath);
+
     // Enable Depth testing
-    glEnable(GL_DEPTH_TEST);
+    gl::StateCache::get().setEnabled(GL_DEPTH_TEST, true);
 
     // Initialize glText and create a text object
     gltInit();
     m_text = gltCreateText();
 }
 
+void App::pace()
+{
+    // Idle frames are often not presented, so only the pacer can hold their rate
+    int fps = m_bIdle ? m_idleFPS : m_maxFPS;
+    int interval = 1;
+
+    if (m_bVSync && !m_bIdle)
+    {
+        SDL_DisplayMode mode;
+        int refresh = 0;
+        if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(m_window), &mode) == 0)
+            refresh = mode.refresh_rate;
+
+        // The swap already waits for the display when the cap is at or above its rate,
+        // and every n-th refresh is smoother than the pacer for rates that divide it
+        if (refresh > 0 && fps >= refresh)
+            fps = 0;
+        else if (refresh > 0 && fps > 0 && refresh % fps == 0)
+        {
+            interval = refresh / fps;
+            fps = 0;
+        }
+    }
+
+    if (m_bVSync && interval != m_swapInterval)
+    {
+        m_swapInterval = interval;
+        SDL_GL_SetSwapInterval(interval);
+    }
+
+    m_pacer.setRate(fps);
+}
+
 void App::setClearColor(int r, int g, int b, int a)
 {
     float _r = r / 255.0f;
@@ -242,6 +537,11 @@ void App::setClearColor(int r, int g, int b, int a)
     glClearColor(_r, _g, _b, _a);
 }
 
+void App::clearFrame()
+{
+    glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+}
+
 void App::drawText(const char * text, float x, float y, float scale, float r, float g, float b, float a)
 {
     gltSetText(m_text, text);
@@ -251,4 +551,7 @@ void App::drawText(const char * text, float x, float y, float scale, float r, fl
     gltDrawText2D(m_text, x, y, scale);
 
     gltEndDraw();
+
+    // gltext binds its program, VAO and font texture behind the state cache
+    gl::StateCache::get().invalidate();
 }
@@ -8,31 +8,84 @@
 #endif
 
 #include <string>
+#include <memory>
 
+// Measures time on the performance counter (sub-microsecond on the usual platforms)
 class Clock
 {
 public:
     Clock();
 
+    // Seconds since the last restart, starts over
     float restart();
+    // Seconds since the last restart
+    double elapsed() const;
 
 private:
-    Uint32 m_start, m_end;
+    Uint64 m_start;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+    Holds a frame rate by waiting for fixed deadlines. Most of the wait is slept with
+    SDL_Delay, which can wake up late, so the last stretch before the deadline is spun
+    on the performance counter. The spun stretch follows how late the sleeps have been
+    recently, which keeps the CPU use low where sleeps are accurate.
+
+    Deadlines advance by exactly one period so the rate doesn't drift, a frame that is
+    more than a period late starts the schedule over instead of rushing to catch up.
+*/
+class FramePacer
+{
+public:
+    FramePacer();
+
+    // Frames per second, 0 doesn't wait at all
+    void setRate(double fps);
+    double getRate() const;
+
+    // Returns when the next frame is due
+    void wait();
+
+private:
+    double m_rate;
+    Uint64 m_frequency;
+    Uint64 m_period;    // counter ticks, 0 when off
+    Uint64 m_deadline;  // 0 until the first frame
+    Uint64 m_spin;      // counter ticks spun before every deadline
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 struct GLTtext;
+class HeadlessContext;
+class FrameCapture;
+namespace gl { struct Framebuffer; }
 
 class App
 {
 public:
-    App(const char* title, int width, int height);
+    // Headless apps have no window, they render through EGL into an offscreen framebuffer
+    App(const char* title, int width, int height, bool headless = false);
     ~App();
 
     void Run();
     void Quit();
 
+    // Stops Run after this many presented frames, 0 runs until Quit
+    void FrameLimit(int frames);
+    // Every Loop gets exactly this elapsed time and idle frames don't sleep (offline
+    // rendering), 0 goes back to the real frame time
+    void FixedTimestep(float seconds);
+    // Writes the last rendered frame as a binary PPM (headless only)
+    bool SaveFrame(const std::string& path);
+
+    // Every presented frame is read back into the capture until StopCapture
+    void StartCapture(std::unique_ptr<FrameCapture> capture);
+    void StopCapture();
+    bool IsCapturing() const;
+
 protected:
     SDL_Window* m_window;
     SDL_GLContext m_maincontext;
@@ -43,19 +96,43 @@ protected:
     bool m_bFocus;
     bool m_bQuit;
     bool m_bIsFullscreen;
+    bool m_bIdle;
+    bool m_bSkipFrame;
+    int  m_idleFPS;
+    int  m_maxFPS;
+    bool m_bVSync;
+    int  m_swapInterval;
+    bool m_bHeadless;
+    int  m_frameLimit;
+    int  m_frameCount;
+    float m_fixedTimestep;
 
     const Uint8 *m_keys;
 
-    Clock m_clock;
+    std::unique_ptr<HeadlessContext> m_headless;
+    std::unique_ptr<gl::Framebuffer> m_target;
+    std::unique_ptr<FrameCapture>    m_capture;
+
+    Clock      m_clock;
+    FramePacer m_pacer;
+    // Average frame time in seconds, for the FPS counter
+    float      m_frameTime;
 
     void sdl_die(const char* message);
     void init_screen(const char* title);
+    void init_headless();
+    void init_gl(void* (*loader)(const char*));
+    // Picks the swap interval and pacer rate for the current frame
+    void pace();
 
     virtual bool Event(SDL_Event& e) = 0;
     virtual bool Setup() = 0;
     virtual bool Loop(float elapsedTime) = 0;
 
     void setClearColor(int r, int g, int b, int a);
+    // Clears the frame, Loop calls it once it knows the frame is drawn (a skipped
+    // frame keeps the last one)
+    void clearFrame();
 
     void drawText(const char* text, float x, float y, float scale, float r, float g, float b, float a);
     GLTtext* m_text;
@@ -68,11 +145,21 @@ protected:
 
     void FPSCounter(bool fpscounter);
     void WireFrame(bool wireframe);
+    // The swap waits for the display, frame rates that divide the refresh rate are held
+    // by swapping every n-th refresh instead of the pacer
     void VSync(bool vsync);
     void Culling(bool cull);
     void ShowCursor(bool cursor);
     void Fullscreen(bool fullscreen);
 
+    // Caps the frame rate, 0 is uncapped (or the refresh rate with vsync)
+    void MaxFPS(int fps);
+    // While idle the main loop is limited to m_idleFPS
+    void Idle(bool idle);
+    void IdleFPS(int fps);
+    // Called from Loop when nothing new was drawn, the frame is not presented
+    void SkipFrame();
+
     bool MouseHold(int key);
 };
 
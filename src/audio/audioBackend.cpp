@@ -0,0 +1,116 @@
+#include "audioBackend.h"
+
+#include "bassBackend.h"
+#include "nullBackend.h"
+
+AudioBackend::AudioBackend(const nlohmann::json& config)
+    : m_handle(0)
+    , m_config(config)
+{
+}
+
+AudioBackend::~AudioBackend()
+{
+    // Cleanup BASS
+    freeStream();
+    BASS_Free();
+}
+
+std::unique_ptr<AudioBackend> AudioBackend::create(const nlohmann::json& config)
+{
+    std::string backend = config["bass"].value("backend", "bass");
+
+    if (backend == "null")
+        return std::make_unique<NullBackend>(config);
+    else if (backend != "bass")
+        printf("Unknown audio backend '%s', using bass\n", backend.c_str());
+
+    return std::make_unique<BassBackend>(config);
+}
+
+void AudioBackend::stop()
+{
+    BASS_ChannelStop(m_handle);
+}
+
+void AudioBackend::pause()
+{
+    BASS_ChannelPause(m_handle);
+}
+
+void AudioBackend::resume()
+{
+    BASS_ChannelPlay(m_handle, false);
+}
+
+bool AudioBackend::isPaused()
+{
+    return BASS_ChannelIsActive(m_handle) == BASS_ACTIVE_PAUSED;
+}
+
+void AudioBackend::update(float /*elapsed*/)
+{
+}
+
+void AudioBackend::setVolume(float volume)
+{
+    BASS_ChannelSetAttribute(m_handle, BASS_ATTRIB_VOL, volume);
+}
+
+int AudioBackend::getSampleRate()
+{
+    BASS_CHANNELINFO info;
+    if (BASS_ChannelGetInfo(m_handle, &info))
+        return info.freq;
+
+    return m_config["bass"].value("sampleRate", 44100);
+}
+
+bool AudioBackend::record(const std::string& wavPath)
+{
+    printf("This audio backend can't record to %s\n", wavPath.c_str());
+    return false;
+}
+
+float AudioBackend::getOutputLatency()
+{
+    return 0.0f;
+}
+
+HSTREAM AudioBackend::createStream(const std::string& path, DWORD flags)
+{
+    // Synthetic sources ("synth:<type>") are fed to BASS through a user stream
+    SignalGenerator::Type type;
+    if (SignalGenerator::parse(path, type))
+    {
+        auto synthConfig = m_config.value("synth", nlohmann::json::object());
+        int rate = synthConfig.value("sampleRate", m_config["bass"].value("sampleRate", 44100));
+
+        m_generator = std::make_unique<SignalGenerator>(type, rate, synthConfig);
+        return BASS_StreamCreate(rate, 2, flags | BASS_SAMPLE_FLOAT, &SynthStreamProc, m_generator.get());
+    }
+
+    return BASS_StreamCreateFile(false, path.data(), 0, 0, flags);
+}
+
+void AudioBackend::freeStream()
+{
+    // Stop any previous audio from playing (also it clears the buffer by stopping it)
+    BASS_ChannelStop(m_handle);
+    BASS_StreamFree(m_handle); // Important! memory leak otherwise
+    m_handle = 0;
+    m_generator.reset();
+}
+
+DWORD CALLBACK AudioBackend::SynthStreamProc(HSTREAM /*handle*/, void* buffer, DWORD length, void* user)
+{
+    auto generator = static_cast<SignalGenerator*>(user);
+
+    // length is in bytes of interleaved stereo floats
+    DWORD frames = length / (2 * sizeof(float));
+    DWORD written = generator->render(static_cast<float*>(buffer), frames) * 2 * sizeof(float);
+
+    if (generator->finished())
+        written |= BASS_STREAMPROC_END;
+    return written;
+}
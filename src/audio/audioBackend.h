@@ -0,0 +1,71 @@
+#ifndef AUDIOBACKEND_H
+#define AUDIOBACKEND_H
+
+#include <bass.h>
+#include <string>
+#include <memory>
+
+#include "../libs/json.hpp"
+#include "../signalGenerator.h"
+
+// Interface over the BASS calls used by the visualiser so playback can be swapped
+// for a decode-only backend on machines without an audio device
+class AudioBackend
+{
+public:
+    AudioBackend(const nlohmann::json& config);
+    virtual ~AudioBackend();
+
+    // Creates the backend selected by config["bass"]["backend"] ("bass" or "null")
+    static std::unique_ptr<AudioBackend> create(const nlohmann::json& config);
+
+    virtual bool init(int deviceID, int sampleRate) = 0;
+
+    // Stops the current stream and starts the given file or synthetic source
+    virtual bool play(const std::string& path) = 0;
+    virtual void stop();
+
+    virtual void pause();
+    virtual void resume();
+    virtual bool isPaused();
+
+    // Returns false once the current stream has finished
+    virtual bool isActive() = 0;
+
+    // Advances the backend by one frame (only the null backend keeps its own clock)
+    virtual void update(float elapsed);
+
+    // Same as BASS_ChannelGetData with one of the BASS_DATA_FFT* flags
+    virtual bool getFFT(float* buffer, DWORD fftFlag) = 0;
+
+    // Copies the newest interleaved float samples (sample tap), returns how many were written
+    virtual int getSamples(float* buffer, int count) = 0;
+
+    virtual void setVolume(float volume);
+
+    // Also writes everything decoded from the next stream on into a WAV file
+    // (decode-only backends, returns false when unsupported)
+    virtual bool record(const std::string& wavPath);
+
+    // Sample rate of the current stream (falls back to the configured rate)
+    int getSampleRate();
+
+    // Delay in seconds between data being analysed and it being heard
+    // (device latency plus whatever is still in the playback buffer)
+    virtual float getOutputLatency();
+
+protected:
+    HSTREAM        m_handle;
+    nlohmann::json m_config;
+
+    std::unique_ptr<SignalGenerator> m_generator;
+
+    // Opens a file or "synth:<type>" source with the given BASS_STREAM_* flags
+    HSTREAM createStream(const std::string& path, DWORD flags);
+    void freeStream();
+
+private:
+    static DWORD CALLBACK SynthStreamProc(HSTREAM handle, void* buffer, DWORD length, void* user);
+};
+
+#endif
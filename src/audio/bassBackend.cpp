@@ -0,0 +1,96 @@
+#include "bassBackend.h"
+
+BassBackend::BassBackend(const nlohmann::json& config)
+    : AudioBackend(config)
+    , m_deviceLatency(0.0f)
+{
+}
+
+bool BassBackend::init(int deviceID, int sampleRate)
+{
+    // BASS_CONFIG_DEV_BUFFER only has an effect before BASS_Init
+    applyLowLatencyProfile();
+
+    if (!BASS_Init(deviceID, sampleRate, BASS_DEVICE_LATENCY, 0, nullptr))
+    {
+        printf("BASS_Init failed with error code %d\n", BASS_ErrorGetCode());
+        return false;
+    }
+
+    BASS_INFO info;
+    if (BASS_GetInfo(&info))
+    {
+        m_deviceLatency = info.latency / 1000.0f;
+        printf("Output device latency: %d ms (minimum buffer %d ms)\n", (int)info.latency, (int)info.minbuf);
+
+        // The playback buffer must cover the device buffer plus one update period or it will underrun
+        DWORD buffer = BASS_GetConfig(BASS_CONFIG_BUFFER);
+        DWORD needed = info.minbuf + BASS_GetConfig(BASS_CONFIG_UPDATEPERIOD);
+        if (buffer < needed)
+        {
+            printf("Playback buffer %d ms is below the recommended %d ms, raising it\n", (int)buffer, (int)needed);
+            BASS_SetConfig(BASS_CONFIG_BUFFER, needed);
+        }
+    }
+    return true;
+}
+
+bool BassBackend::play(const std::string& path)
+{
+    freeStream();
+    m_handle = createStream(path, 0);
+
+    if (!BASS_ChannelPlay(m_handle, false))
+    {
+        printf("Could not load audio file... %s\n", path.c_str());
+        return false;
+    }
+
+    printf("Now playing... %s\n", path.c_str());
+    return true;
+}
+
+bool BassBackend::isActive()
+{
+    return BASS_ChannelIsActive(m_handle) != BASS_ACTIVE_STOPPED;
+}
+
+int BassBackend::getSamples(float* buffer, int count)
+{
+    // Playing channels return the data being heard without removing it
+    DWORD bytes = BASS_ChannelGetData(m_handle, buffer, (count * sizeof(float)) | BASS_DATA_FLOAT);
+    if (bytes == (DWORD)-1)
+        return 0;
+
+    return bytes / sizeof(float);
+}
+
+float BassBackend::getOutputLatency()
+{
+    // Amount of data already decoded into the playback buffer but not yet heard
+    DWORD buffered = BASS_ChannelGetData(m_handle, nullptr, BASS_DATA_AVAILABLE);
+    if (buffered == (DWORD)-1)
+        return m_deviceLatency;
+
+    return m_deviceLatency + (float)BASS_ChannelBytes2Seconds(m_handle, buffered);
+}
+
+bool BassBackend::getFFT(float* buffer, DWORD fftFlag)
+{
+    return BASS_ChannelGetData(m_handle, buffer, fftFlag) != (DWORD)-1;
+}
+
+void BassBackend::applyLowLatencyProfile()
+{
+    auto profile = m_config["bass"].value("lowLatency", nlohmann::json::object());
+    if (!profile.value("enabled", false))
+        return;
+
+    // All values are in milliseconds
+    BASS_SetConfig(BASS_CONFIG_BUFFER,       profile.value("buffer", 40));
+    BASS_SetConfig(BASS_CONFIG_UPDATEPERIOD, profile.value("updatePeriod", 5));
+    BASS_SetConfig(BASS_CONFIG_DEV_BUFFER,   profile.value("devBuffer", 10));
+
+    printf("Using low latency profile: buffer %d ms, update period %d ms, device buffer %d ms\n",
+        (int)BASS_GetConfig(BASS_CONFIG_BUFFER), (int)BASS_GetConfig(BASS_CONFIG_UPDATEPERIOD), (int)BASS_GetConfig(BASS_CONFIG_DEV_BUFFER));
+}
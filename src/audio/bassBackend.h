@@ -0,0 +1,26 @@
+#ifndef BASSBACKEND_H
+#define BASSBACKEND_H
+
+#include "audioBackend.h"
+
+// Plays streams on a real output device
+class BassBackend : public AudioBackend
+{
+public:
+    BassBackend(const nlohmann::json& config);
+
+    bool init(int deviceID, int sampleRate) override;
+    bool play(const std::string& path) override;
+    bool isActive() override;
+    bool getFFT(float* buffer, DWORD fftFlag) override;
+    int getSamples(float* buffer, int count) override;
+    float getOutputLatency() override;
+
+private:
+    // Average device delay reported by BASS_GetInfo in seconds
+    float m_deviceLatency;
+
+    void applyLowLatencyProfile();
+};
+
+#endif
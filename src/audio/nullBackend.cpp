@@ -0,0 +1,179 @@
+#include "nullBackend.h"
+
+#include <algorithm>
+
+NullBackend::NullBackend(const nlohmann::json& config)
+    : AudioBackend(config)
+    , m_clock(0.0)
+    , m_frame(0)
+    , m_ended(true)
+    , m_paused(false)
+    , m_rate(0)
+    , m_channels(0)
+    , m_decodedFrames(0)
+    , m_historyPos(0)
+    , m_fftStream(0)
+{
+    auto nullConfig = m_config["bass"].value("null", nlohmann::json::object());
+
+    // "realtime" follows the frame time, "fast" advances 1/fps per frame
+    m_realtime = nullConfig.value("clock", "realtime") != "fast";
+    m_step     = 1.0 / nullConfig.value("fps", 60.0);
+}
+
+bool NullBackend::init(int /*deviceID*/, int sampleRate)
+{
+    // Device 0 is the "no sound" device, decoding channels don't need anything else
+    if (!BASS_Init(0, sampleRate, 0, 0, nullptr))
+    {
+        printf("BASS_Init failed with error code %d\n", BASS_ErrorGetCode());
+        return false;
+    }
+
+    printf("Using null audio backend (%s clock)\n", m_realtime ? "realtime" : "fast");
+    return true;
+}
+
+bool NullBackend::play(const std::string& path)
+{
+    freeStream();
+    freeFFTStream();
+
+    m_handle = createStream(path, BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT);
+
+    BASS_CHANNELINFO info;
+    if (!BASS_ChannelGetInfo(m_handle, &info))
+    {
+        printf("Could not load audio file... %s\n", path.c_str());
+        m_ended = true;
+        return false;
+    }
+
+    m_rate     = info.freq;
+    m_channels = info.chans;
+    m_fftStream = BASS_StreamCreate(m_rate, m_channels, BASS_SAMPLE_FLOAT | BASS_STREAM_DECODE, STREAMPROC_PUSH, nullptr);
+
+    m_history.assign(HISTORY_FRAMES * m_channels, 0.0f);
+    m_historyPos    = 0;
+    m_decodedFrames = 0;
+    m_clock         = 0.0;
+    m_frame         = 0;
+    m_ended         = false;
+
+    if (!m_recordPath.empty())
+        m_recorder.open(m_recordPath, m_rate, m_channels);
+    m_paused        = false;
+
+    printf("Now decoding... %s\n", path.c_str());
+    return true;
+}
+
+void NullBackend::stop()
+{
+    m_ended = true;
+    m_recorder.close();
+}
+
+void NullBackend::pause()
+{
+    m_paused = true;
+}
+
+void NullBackend::resume()
+{
+    m_paused = false;
+}
+
+bool NullBackend::isPaused()
+{
+    return m_paused;
+}
+
+bool NullBackend::isActive()
+{
+    return !m_ended;
+}
+
+void NullBackend::update(float elapsed)
+{
+    if (m_ended || m_paused)
+        return;
+
+    // Fixed steps are counted, so frame n is analysed at exactly n / fps
+    if (m_realtime) m_clock += elapsed;
+    else            m_clock = m_frame++ * m_step;
+    decodeTo((int64_t)(m_clock * m_rate));
+}
+
+bool NullBackend::getFFT(float* buffer, DWORD fftFlag)
+{
+    if (!m_fftStream)
+        return false;
+
+    // BASS_DATA_FFT256 = 0x80000000 up to BASS_DATA_FFT32768 = 0x80000007
+    int window = 256 << (fftFlag & 7);
+
+    // Push the newest window of decoded frames (oldest first) and let BASS transform it
+    int start = (m_historyPos - window + HISTORY_FRAMES) % HISTORY_FRAMES;
+    int first = std::min(window, HISTORY_FRAMES - start);
+
+    BASS_StreamPutData(m_fftStream, &m_history[start * m_channels], first * m_channels * sizeof(float));
+    if (first < window)
+        BASS_StreamPutData(m_fftStream, &m_history[0], (window - first) * m_channels * sizeof(float));
+
+    return BASS_ChannelGetData(m_fftStream, buffer, fftFlag) != (DWORD)-1;
+}
+
+int NullBackend::getSamples(float* buffer, int count)
+{
+    if (m_history.empty())
+        return 0;
+
+    // Newest whole frames from the history ring
+    int frames = std::min(count / m_channels, HISTORY_FRAMES);
+    int pos = (m_historyPos - frames + HISTORY_FRAMES) % HISTORY_FRAMES;
+    for (int i = 0; i < frames; i++)
+    {
+        std::copy_n(&m_history[pos * m_channels], m_channels, &buffer[i * m_channels]);
+        pos = (pos + 1) % HISTORY_FRAMES;
+    }
+    return frames * m_channels;
+}
+
+bool NullBackend::record(const std::string& wavPath)
+{
+    m_recordPath = wavPath;
+    return true;
+}
+
+void NullBackend::decodeTo(int64_t frame)
+{
+    int64_t frames = frame - m_decodedFrames;
+    if (frames <= 0)
+        return;
+
+    m_decodeBuffer.resize(frames * m_channels);
+    DWORD bytes = BASS_ChannelGetData(m_handle, m_decodeBuffer.data(), (DWORD)(m_decodeBuffer.size() * sizeof(float)) | BASS_DATA_FLOAT);
+
+    int64_t got = (bytes == (DWORD)-1) ? 0 : bytes / (m_channels * sizeof(float));
+    if (got < frames)
+        m_ended = true;
+
+    m_recorder.write(m_decodeBuffer.data(), got * m_channels);
+    if (m_ended)
+        m_recorder.close();
+
+    // Copy into the history ring
+    for (int64_t i = 0; i < got; i++)
+    {
+        std::copy_n(&m_decodeBuffer[i * m_channels], m_channels, &m_history[m_historyPos * m_channels]);
+        m_historyPos = (m_historyPos + 1) % HISTORY_FRAMES;
+    }
+    m_decodedFrames += got;
+}
+
+void NullBackend::freeFFTStream()
+{
+    BASS_StreamFree(m_fftStream);
+    m_fftStream = 0;
+}
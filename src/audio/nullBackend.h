@@ -0,0 +1,60 @@
+#ifndef NULLBACKEND_H
+#define NULLBACKEND_H
+
+#include <vector>
+
+#include "audioBackend.h"
+#include "wavWriter.h"
+
+// Decode-only backend that needs no audio device. Streams are opened with
+// BASS_STREAM_DECODE and decoded up to a virtual clock which either follows
+// real time or advances by a fixed step per frame (as fast as possible).
+class NullBackend : public AudioBackend
+{
+public:
+    NullBackend(const nlohmann::json& config);
+
+    bool init(int deviceID, int sampleRate) override;
+    bool play(const std::string& path) override;
+    void stop() override;
+    void pause() override;
+    void resume() override;
+    bool isPaused() override;
+    bool isActive() override;
+    void update(float elapsed) override;
+    bool getFFT(float* buffer, DWORD fftFlag) override;
+    int getSamples(float* buffer, int count) override;
+    bool record(const std::string& wavPath) override;
+
+private:
+    // Largest FFT window (BASS_DATA_FFT32768)
+    static const int HISTORY_FRAMES = 32768;
+
+    bool   m_realtime;
+    double m_step;
+    double m_clock;
+    int64_t m_frame;
+    bool   m_ended;
+    bool   m_paused;
+
+    int     m_rate;
+    int     m_channels;
+    int64_t m_decodedFrames;
+
+    // Ring of the most recently decoded interleaved frames
+    std::vector<float> m_history;
+    int                m_historyPos;
+    std::vector<float> m_decodeBuffer;
+
+    // Decoding push stream used to run the BASS FFT over the history
+    HSTREAM m_fftStream;
+
+    // Decoded audio is also written here while recording
+    std::string m_recordPath;
+    WavWriter   m_recorder;
+
+    void decodeTo(int64_t frame);
+    void freeFFTStream();
+};
+
+#endif
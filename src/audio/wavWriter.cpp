@@ -0,0 +1,93 @@
+#include "wavWriter.h"
+
+#include <vector>
+#include <algorithm>
+
+WavWriter::WavWriter()
+    : m_file(nullptr)
+    , m_channels(0)
+    , m_dataBytes(0)
+{
+}
+
+WavWriter::~WavWriter()
+{
+    close();
+}
+
+bool WavWriter::open(const std::string& path, int sampleRate, int channels)
+{
+    close();
+
+    m_file = fopen(path.c_str(), "wb");
+    if (m_file == nullptr)
+    {
+        printf("Could not open %s for writing\n", path.c_str());
+        return false;
+    }
+
+    m_channels  = channels;
+    m_dataBytes = 0;
+    writeHeader(sampleRate);
+    return true;
+}
+
+void WavWriter::write(const float* samples, size_t count)
+{
+    if (m_file == nullptr || count == 0)
+        return;
+
+    std::vector<int16_t> pcm(count);
+    for (size_t i = 0; i < count; i++)
+        pcm[i] = (int16_t)(std::max(-1.0f, std::min(1.0f, samples[i])) * 32767.0f);
+
+    fwrite(pcm.data(), sizeof(int16_t), count, m_file);
+    m_dataBytes += (uint32_t)(count * sizeof(int16_t));
+}
+
+void WavWriter::close()
+{
+    if (m_file == nullptr)
+        return;
+
+    // RIFF and data chunk sizes
+    uint32_t riffBytes = 36 + m_dataBytes;
+    fseek(m_file, 4, SEEK_SET);
+    fwrite(&riffBytes, 4, 1, m_file);
+    fseek(m_file, 40, SEEK_SET);
+    fwrite(&m_dataBytes, 4, 1, m_file);
+
+    fclose(m_file);
+    m_file = nullptr;
+}
+
+bool WavWriter::isOpen()
+{
+    return m_file != nullptr;
+}
+
+void WavWriter::writeHeader(int sampleRate)
+{
+    uint16_t format        = 1; // PCM
+    uint16_t channels      = (uint16_t)m_channels;
+    uint32_t rate          = (uint32_t)sampleRate;
+    uint16_t blockAlign    = (uint16_t)(m_channels * sizeof(int16_t));
+    uint32_t byteRate      = rate * blockAlign;
+    uint16_t bitsPerSample = 16;
+    uint32_t formatBytes   = 16;
+    uint32_t placeholder   = 0;
+
+    // Little endian, like every platform this builds on
+    fwrite("RIFF", 1, 4, m_file);
+    fwrite(&placeholder, 4, 1, m_file);
+    fwrite("WAVEfmt ", 1, 8, m_file);
+    fwrite(&formatBytes, 4, 1, m_file);
+    fwrite(&format, 2, 1, m_file);
+    fwrite(&channels, 2, 1, m_file);
+    fwrite(&rate, 4, 1, m_file);
+    fwrite(&byteRate, 4, 1, m_file);
+    fwrite(&blockAlign, 2, 1, m_file);
+    fwrite(&bitsPerSample, 2, 1, m_file);
+    fwrite("data", 1, 4, m_file);
+    fwrite(&placeholder, 4, 1, m_file);
+}
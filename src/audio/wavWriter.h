@@ -0,0 +1,30 @@
+#ifndef WAVWRITER_H
+#define WAVWRITER_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+
+// Writes interleaved float samples as a 16-bit PCM WAV file, the header sizes
+// are filled in on close
+class WavWriter
+{
+public:
+    WavWriter();
+    ~WavWriter();
+
+    bool open(const std::string& path, int sampleRate, int channels);
+    void write(const float* samples, size_t count);
+    void close();
+
+    bool isOpen();
+
+private:
+    FILE*    m_file;
+    int      m_channels;
+    uint32_t m_dataBytes;
+
+    void writeHeader(int sampleRate);
+};
+
+#endif
@@ -0,0 +1,194 @@
+#include "bloom.h"
+
+#ifdef _WIN32
+#include <SDL.h>
+#elif __linux__
+#include <SDL2/SDL.h>
+#endif
+#include <algorithm>
+
+Bloom::Bloom(const nlohmann::json& config)
+    : m_threshold(config.value("threshold", 0.6f))
+    , m_knee(config.value("knee", 0.2f))
+    , m_intensity(config.value("intensity", 1.0f))
+    , m_maxLevels(std::max(2, config.value("levels", 5)))
+    , m_quality(std::min(std::max(config.value("quality", (int)MAX_QUALITY), 0), (int)MAX_QUALITY))
+    , m_bAutoQuality(config.value("autoQuality", true))
+    , m_budget(config.value("budget", 1.0f))
+    , m_levelCount(0)
+    , m_bRaised(false)
+{
+    // Get basepath for the assets folder
+    char* basePath = SDL_GetBasePath();
+    std::string shaderPath = basePath + std::string("assets/shaders/");
+    SDL_free(basePath);
+    // Every pass draws the same full screen triangle
+    std::string fullscreen = shaderPath + "fullscreen.vert";
+
+    // Every sampler reads texture unit 0 (the default)
+    static const char* const prefilterUniforms[P_COUNT] = { "sourceTexel", "targetTexel", "threshold", "knee" };
+    m_chain[PREFILTER].createProgram(fullscreen, shaderPath + "bloomPrefilter.frag");
+    m_chain[PREFILTER].resolveUniforms(prefilterUniforms);
+
+    static const char* const chainUniforms[C_COUNT] = { "sourceTexel", "targetTexel" };
+    m_chain[DOWNSAMPLE].createProgram(fullscreen, shaderPath + "bloomDownsample.frag");
+    m_chain[DOWNSAMPLE].resolveUniforms(chainUniforms);
+    m_chain[UPSAMPLE].createProgram(fullscreen, shaderPath + "bloomUpsample.frag");
+    m_chain[UPSAMPLE].resolveUniforms(chainUniforms);
+
+    static const char* const compositeUniforms[K_COUNT] = { "targetTexel", "intensity" };
+    m_composite.createProgram(fullscreen, shaderPath + "bloomComposite.frag");
+    m_composite.resolveUniforms(compositeUniforms);
+}
+
+void Bloom::apply()
+{
+    if (m_quality == QUALITY_OFF)
+    {
+        // Counts the frames until quality 0 is tried again
+        m_cost.skip();
+        adjustQuality();
+        return;
+    }
+
+    // Where the frame is, everything is sized from its viewport
+    GLint output, viewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &output);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    allocate(viewport[2], viewport[3]);
+
+    m_cost.update();
+    m_cost.begin();
+
+    // The only read of the whole frame, filtered down to the first level size
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, output);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_source->fbo);
+    glBlitFramebuffer(viewport[0], viewport[1], viewport[0] + viewport[2], viewport[1] + viewport[3],
+        0, 0, m_source->width, m_source->height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+    gl::StateCache& state = gl::StateCache::get();
+    state.setEnabled(GL_DEPTH_TEST, false);
+    m_VAO.Bind();
+
+    // Threshold at the same size, the taps on texel corners blur it slightly
+    gl::Shader& prefilter = m_chain[PREFILTER];
+    prefilter.Bind();
+    prefilter.loadFloat(prefilter.uniform(P_THRESHOLD), m_threshold);
+    prefilter.loadFloat(prefilter.uniform(P_KNEE), m_knee);
+    m_levels[0]->bind();
+    draw(PREFILTER, m_source->colour, 0.5f / glm::vec2(m_source->width, m_source->height), *m_levels[0]);
+
+    for (int i = 1; i < m_levelCount; i++)
+    {
+        m_levels[i]->bind();
+        draw(DOWNSAMPLE, m_levels[i - 1]->colour, 1.0f / glm::vec2(m_levels[i - 1]->width, m_levels[i - 1]->height), *m_levels[i]);
+    }
+
+    // Each level adds the blurred smaller one on top of its own
+    state.setEnabled(GL_BLEND, true);
+    state.blendFunc(GL_ONE, GL_ONE);
+    for (int i = m_levelCount - 1; i > 0; i--)
+    {
+        m_levels[i - 1]->bind();
+        draw(UPSAMPLE, m_levels[i]->colour, 1.0f / glm::vec2(m_levels[i]->width, m_levels[i]->height), *m_levels[i - 1]);
+    }
+
+    // The glow added over the frame
+    glBindFramebuffer(GL_FRAMEBUFFER, output);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    m_composite.Bind();
+    m_composite.loadVector2(m_composite.uniform(K_TARGET_TEXEL), 1.0f / glm::vec2(viewport[2], viewport[3]));
+    m_composite.loadFloat(m_composite.uniform(K_INTENSITY), m_intensity);
+    state.bindTexture(0, GL_TEXTURE_2D, m_levels[0]->colour);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    m_VAO.Unbind();
+    m_composite.Unbind();
+
+    state.setEnabled(GL_BLEND, false);
+    state.setEnabled(GL_DEPTH_TEST, true);
+
+    m_cost.end();
+    adjustQuality();
+}
+
+float Bloom::getCost() const
+{
+    return m_cost.get();
+}
+
+int Bloom::getQuality() const
+{
+    return m_quality;
+}
+
+void Bloom::allocate(int width, int height)
+{
+    // Lower qualities start smaller and stop earlier
+    int shift  = m_quality >= 2 ? 1 : 3 - m_quality;
+    int levels = m_quality == MAX_QUALITY ? m_maxLevels : m_quality == 2 ? m_maxLevels - 1 : 2;
+
+    int levelWidth  = std::max(1, width >> shift);
+    int levelHeight = std::max(1, height >> shift);
+
+    if (!m_source) m_source = std::make_unique<gl::Framebuffer>(levelWidth, levelHeight, GL_RGBA8, false);
+    else           m_source->resize(levelWidth, levelHeight);
+
+    m_levelCount = 0;
+    while (m_levelCount < levels && (m_levelCount == 0 || (levelWidth >= 2 && levelHeight >= 2)))
+    {
+        if ((int)m_levels.size() <= m_levelCount)
+            m_levels.push_back(std::make_unique<gl::Framebuffer>(levelWidth, levelHeight, GL_RGBA8, false));
+        else
+            m_levels[m_levelCount]->resize(levelWidth, levelHeight);
+
+        m_levelCount++;
+        levelWidth  = std::max(1, levelWidth / 2);
+        levelHeight = std::max(1, levelHeight / 2);
+    }
+}
+
+void Bloom::draw(Pass pass, GLuint source, glm::vec2 sourceTexel, gl::Framebuffer& target)
+{
+    gl::Shader& shader = m_chain[pass];
+    shader.Bind();
+    shader.loadVector2(shader.uniform(C_SOURCE_TEXEL), sourceTexel);
+    shader.loadVector2(shader.uniform(C_TARGET_TEXEL), 1.0f / glm::vec2(target.width, target.height));
+    gl::StateCache::get().bindTexture(0, GL_TEXTURE_2D, source);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+void Bloom::adjustQuality()
+{
+    if (!m_bAutoQuality || !m_cost.settled())
+        return;
+
+    // Down as soon as the average is over budget, up only after a long stretch well
+    // under it, and slower every time going up had to be undone
+    if (m_quality == QUALITY_OFF)
+    {
+        // No cost to compare while off, only the wait
+        if (m_cost.frames() < m_cost.wait())
+            return;
+
+        m_quality = 0;
+        m_bRaised = true;
+    }
+    else if (m_cost.get() > m_budget && m_quality > QUALITY_OFF)
+    {
+        m_quality--;
+        if (m_bRaised)
+            m_cost.backoff();
+        m_bRaised = false;
+    }
+    else if (m_cost.get() < m_budget * 0.5f && m_quality < MAX_QUALITY && m_cost.frames() >= m_cost.wait())
+    {
+        m_quality++;
+        m_bRaised = true;
+    }
+    else
+        return;
+
+    m_cost.restart();
+}
@@ -0,0 +1,102 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <vector>
+#include <memory>
+
+#include "gl/glObjects.h"
+#include "libs/json.hpp"
+
+/*
+    Glow around the bright parts of what has been drawn. apply() works on the bound
+    framebuffer through a mip chain of small targets, nothing but the final add
+    touches full resolution:
+
+        blit        the frame is scaled down into the first level size (linear)
+        prefilter   threshold with a soft knee
+        downsample  each level is half of the previous one (4 bilinear taps)
+        upsample    back up, each level adds a 3x3 tent of the smaller one (additive)
+        composite   level 0 is added over the frame (one tap per pixel)
+
+    The kernels are small separable ones ([1 2 1] tent, 4x4 box), each done in a
+    single pass through bilinear taps.
+
+    The GPU time of apply() is measured with timer queries, which are read back a few
+    frames later and never waited on. With autoQuality the quality drops while the
+    average is over the budget. It comes back once it has stayed well under it:
+
+        quality 3   chain starts at 1/2 resolution, "levels" levels
+        quality 2   1/2 resolution, one level less
+        quality 1   1/4 resolution, two levels
+        quality 0   1/8 resolution, two levels
+        off         apply() does nothing, quality 0 was still over the budget
+
+    Nothing is measured while off, quality 0 is tried again after the same wait
+    as any other raise, and the wait doubles when it is still over the budget.
+
+    Config (bloom):
+        "active":      false
+        "threshold":   0.6      brightness (max of r, g, b) where the glow starts
+        "knee":        0.2      softness of the threshold
+        "intensity":   1.0      glow added to the frame
+        "levels":      5        mip levels at the highest quality
+        "quality":     3        starting quality, 0 - 3
+        "autoQuality": true
+        "budget":      1.0      milliseconds of GPU time
+*/
+class Bloom
+{
+public:
+    static const int MAX_QUALITY = 3;
+    // Below quality 0, only reached through autoQuality
+    static const int QUALITY_OFF = -1;
+
+    Bloom(const nlohmann::json& config);
+
+    // Adds the glow to the bound framebuffer (whole viewport), draw the HUD after it
+    void apply();
+
+    // Average GPU time of apply() in milliseconds, 0 until measured
+    float getCost() const;
+    // 0 - MAX_QUALITY, or QUALITY_OFF
+    int getQuality() const;
+
+private:
+    enum Pass { PREFILTER, DOWNSAMPLE, UPSAMPLE };
+
+    float m_threshold;
+    float m_knee;
+    float m_intensity;
+    int   m_maxLevels;
+    int   m_quality;
+    bool  m_bAutoQuality;
+    float m_budget;
+
+    // Downscaled copy of the frame, then the chain from large to small
+    std::unique_ptr<gl::Framebuffer>              m_source;
+    std::vector<std::unique_ptr<gl::Framebuffer>> m_levels;
+    int m_levelCount;
+
+    gl::VertexArray m_VAO;
+    // Indexed by Pass (bloomPrefilter, bloomDownsample, bloomUpsample), one program
+    // per pass so no pass pays for the taps of another
+    gl::Shader      m_chain[3];
+    gl::Shader      m_composite;
+
+    // GPU time of apply() at the current quality, and the wait before raising it
+    gl::GpuTimeAverage m_cost;
+    bool               m_bRaised;
+
+    // Sizes the chain for the viewport at the current quality
+    void allocate(int width, int height);
+    void draw(Pass pass, GLuint source, glm::vec2 sourceTexel, gl::Framebuffer& target);
+    void adjustQuality();
+
+    // Uniform handles of the m_chain programs, the prefilter has two more
+    enum ChainUniform { C_SOURCE_TEXEL, C_TARGET_TEXEL, C_COUNT };
+    enum PrefilterUniform { P_THRESHOLD = C_COUNT, P_KNEE, P_COUNT };
+    // Uniform handles of m_composite
+    enum CompositeUniform { K_TARGET_TEXEL, K_INTENSITY, K_COUNT };
+};
+
+#endif
@@ -0,0 +1,144 @@
+#include "dynamicResolution.h"
+
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+// Scales are multiples of this, so small changes in the average don't reallocate
+static const float STEP = 0.05f;
+// Going up one step costs at most (0.55 / 0.5)^2 = 1.21 times the pixels, from 70%
+// of the budget that still fits
+static const float LOWER = 0.7f;
+// Part of the frame left to the scene, the rest is HUD, upscale and swap
+static const float SCENE_SHARE = 0.9f;
+// Settle periods a scale has to keep saving too little before going back to maxScale
+static const int SLOW_PERIODS = 2;
+static const int SETTLE_FRAMES = gl::GpuTimeAverage::SETTLE_FRAMES;
+
+DynamicResolution::DynamicResolution(const nlohmann::json& config)
+    : m_minScale(std::min(std::max(config.value("minScale", 0.5f), STEP), 1.0f))
+    , m_maxScale(std::min(std::max(config.value("maxScale", 1.0f), m_minScale), 1.0f))
+    , m_budget(SCENE_SHARE * 1000.0f / std::max(config.value("targetFPS", 60.0f), 1.0f))
+    , m_scale(m_maxScale)
+    , m_frameScale(1.0f)
+    , m_output(0)
+    , m_viewport{ 0, 0, 0, 0 }
+    , m_fullFrameTime(0.0f)
+    , m_slowSince(-1)
+    , m_hold(0)
+{
+}
+
+void DynamicResolution::begin()
+{
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_output);
+    glGetIntegerv(GL_VIEWPORT, m_viewport);
+
+    m_frameTime.update();
+    m_blitTime.update();
+    adjustScale();
+    m_frameTime.begin();
+
+    if (m_scale >= 1.0f)
+    {
+        m_frameScale = 1.0f;
+        return;
+    }
+
+    int width  = std::max(1, (int)(m_viewport[2] * m_scale + 0.5f));
+    int height = std::max(1, (int)(m_viewport[3] * m_scale + 0.5f));
+    m_frameScale = (float)width / std::max(m_viewport[2], 1);
+
+    if (!m_scene) m_scene = std::make_unique<gl::Framebuffer>(width, height);
+    else          m_scene->resize(width, height);
+
+    m_scene->bind();
+    glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+}
+
+void DynamicResolution::end()
+{
+    if (m_frameScale < 1.0f)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_scene->fbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_output);
+        m_blitTime.begin();
+        glBlitFramebuffer(0, 0, m_scene->width, m_scene->height,
+            m_viewport[0], m_viewport[1], m_viewport[0] + m_viewport[2], m_viewport[1] + m_viewport[3],
+            GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        m_blitTime.end();
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_output);
+        glViewport(m_viewport[0], m_viewport[1], m_viewport[2], m_viewport[3]);
+    }
+
+    m_frameTime.end();
+}
+
+float DynamicResolution::getScale() const
+{
+    return m_frameScale;
+}
+
+float DynamicResolution::getFrameTime() const
+{
+    return m_frameTime.get();
+}
+
+void DynamicResolution::adjustScale()
+{
+    if (m_frameTime.frames() < std::max(SETTLE_FRAMES, m_hold))
+        return;
+
+    float frameTime = m_frameTime.get();
+    float scale = m_scale;
+    int   hold  = 0;
+
+    bool bSlow = m_scale < m_maxScale && isSlowerThanExpected();
+    if (!bSlow)
+        m_slowSince = -1;
+    else if (m_slowSince < 0)
+        m_slowSince = m_frameTime.frames();
+
+    if (bSlow)
+    {
+        // One slow stretch may just be a busier scene, it has to stay slow for a while
+        if (m_frameTime.frames() - m_slowSince < SLOW_PERIODS * SETTLE_FRAMES)
+            return;
+
+        printf("Dynamic resolution doesn't pay off here (%.1f ms scaled, %.1f ms full size), trying again in %d frames\n",
+            frameTime, m_fullFrameTime, m_frameTime.wait());
+        scale = m_maxScale;
+        hold = m_frameTime.wait();
+        m_frameTime.backoff();
+    }
+    else if (frameTime > m_budget)
+    {
+        // The cost follows the pixel count, aim a little under the budget and go at
+        // least one step down
+        float fit = m_scale * std::sqrt(m_budget * 0.9f / frameTime);
+        scale = std::min(std::floor(fit / STEP + 0.001f) * STEP, m_scale - STEP);
+    }
+    else if (frameTime < m_budget * LOWER)
+        scale = m_scale + STEP;
+
+    scale = std::min(std::max(scale, m_minScale), m_maxScale);
+    if (std::fabs(scale - m_scale) < STEP * 0.5f)
+        return;
+
+    if (m_scale == m_maxScale)
+        m_fullFrameTime = frameTime;
+    m_scale = scale;
+    m_hold = hold;
+    m_slowSince = -1;
+    m_frameTime.restart();
+}
+
+bool DynamicResolution::isSlowerThanExpected() const
+{
+    float ratio    = m_scale / m_maxScale;
+    float expected = m_fullFrameTime * ratio * ratio + m_blitTime.get();
+
+    // Less than a quarter of the expected saving, or no saving at all
+    return m_frameTime.get() > std::min(m_fullFrameTime * 0.75f + expected * 0.25f, m_fullFrameTime);
+}
@@ -0,0 +1,78 @@
+#ifndef DYNAMICRESOLUTION_H
+#define DYNAMICRESOLUTION_H
+
+#include <memory>
+
+#include "gl/glObjects.h"
+#include "libs/json.hpp"
+
+/*
+    Renders the scene into a target smaller than the screen when the GPU can't keep up,
+    and scales it back up before the HUD is drawn. Everything between begin() and end()
+    goes to the scaled target, at scale 1 it is drawn straight to the screen.
+
+    The GPU time of that span is averaged over frames (timer queries, never waited on)
+    and compared against the frame time of targetFPS, minus a margin for the HUD and
+    presenting. The scale goes down as soon as the average is over it, jumping to
+    where the pixel count should fit. It only goes up one step at a time, after the
+    average has stayed under 70% of the budget. A single step can't push that back
+    over the budget, so it does not oscillate between two sizes.
+
+    The pixel count predicts what a smaller target saves over maxScale, minus the
+    upscale (timed on its own). When less than a quarter of that shows up for a few
+    settle periods, fixed costs or a slow upscale (software renderers) eat it,
+    and it goes back to maxScale. It tries scaling again after a wait, which doubles
+    every time that happens.
+
+    Config (display.dynamicResolution):
+        "active":    false
+        "targetFPS": 60
+        "minScale":  0.5     smallest width and height relative to the screen
+        "maxScale":  1.0
+*/
+class DynamicResolution
+{
+public:
+    DynamicResolution(const nlohmann::json& config);
+
+    // Redirects drawing into the scaled target, sized from the bound framebuffer's viewport
+    void begin();
+    // Upscales into the framebuffer that was bound at begin(), draw the HUD after it
+    void end();
+
+    // Target pixels per screen pixel of the current frame
+    float getScale() const;
+    // Average GPU time of the scene in milliseconds, 0 until measured
+    float getFrameTime() const;
+
+private:
+    float m_minScale;
+    float m_maxScale;
+    float m_budget;
+    float m_scale;
+    float m_frameScale;
+
+    // Where the frame goes, read at begin()
+    GLint m_output;
+    GLint m_viewport[4];
+
+    std::unique_ptr<gl::Framebuffer> m_scene;
+
+    // GPU time of the span at the current scale, and the wait before trying a smaller
+    // one again after it didn't pay off
+    gl::GpuTimeAverage m_frameTime;
+    // Average when the scale last went down from maxScale
+    float              m_fullFrameTime;
+    // The upscale alone, part of m_frameTime
+    gl::GpuTimeAverage m_blitTime;
+
+    // Frame count when the scale started saving less than expected, -1 while it doesn't
+    int m_slowSince;
+    // Frames to stay at maxScale after going back to it
+    int m_hold;
+
+    void adjustScale();
+    bool isSlowerThanExpected() const;
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include "frameCapture.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#include "gl/glObjects.h"
+
+FrameCapture::FrameCapture(Writer writer, int buffers)
+    : m_slots(buffers > 1 ? buffers : 2)
+    , m_next(0)
+    , m_oldest(0)
+    , m_pending(0)
+    , m_frameCount(0)
+    , m_writer(writer)
+    , m_bStop(false)
+    , m_bFinished(false)
+{
+    for (auto& slot : m_slots)
+    {
+        glGenBuffers(1, &slot.buffer);
+        slot.fence  = nullptr;
+        slot.width  = 0;
+        slot.height = 0;
+    }
+
+    m_thread = std::thread(&FrameCapture::writerLoop, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+    finish();
+
+    for (auto& slot : m_slots)
+    {
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+        glDeleteBuffers(1, &slot.buffer);
+        gl::StateCache::get().forgetBuffer(slot.buffer);
+    }
+}
+
+void FrameCapture::capture(int width, int height)
+{
+    if (m_bFinished || width <= 0 || height <= 0)
+        return;
+
+    // Take whatever finished since last frame, only wait if every buffer is still in flight
+    collect(false);
+    if (m_pending == (int)m_slots.size())
+        collect(true);
+
+    Slot& slot = m_slots[m_next];
+    size_t size = (size_t)width * height * 4;
+
+    gl::StateCache::get().bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (slot.width != width || slot.height != height)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        slot.width  = width;
+        slot.height = height;
+    }
+
+    // Into the buffer, the call returns as soon as the copy is queued
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    gl::StateCache::get().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_next = (m_next + 1) % m_slots.size();
+    m_pending++;
+    m_frameCount++;
+}
+
+void FrameCapture::collect(bool wait)
+{
+    while (m_pending > 0)
+    {
+        Slot& slot = m_slots[m_oldest];
+
+        // Only the first wait may block, and the flush makes sure the fence gets there
+        GLenum status = glClientWaitSync(slot.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? GL_TIMEOUT_IGNORED : 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            return;
+        wait = false;
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        Frame frame;
+        frame.width  = slot.width;
+        frame.height = slot.height;
+        size_t rowBytes = (size_t)slot.width * 4;
+
+        {
+            // Don't let a slow writer queue up unbounded memory
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_written.wait(lock, [this] { return (int)m_queue.size() < MAX_QUEUED; });
+            if (!m_free.empty())
+            {
+                frame.pixels = std::move(m_free.back());
+                m_free.pop_back();
+            }
+        }
+        frame.pixels.resize(rowBytes * slot.height);
+
+        gl::StateCache::get().bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        auto mapped = static_cast<const unsigned char*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, rowBytes * slot.height, GL_MAP_READ_BIT));
+        if (mapped)
+        {
+            // GL rows start at the bottom
+            for (int y = 0; y < slot.height; y++)
+                memcpy(frame.pixels.data() + y * rowBytes, mapped + (slot.height - 1 - y) * rowBytes, rowBytes);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        gl::StateCache::get().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        m_oldest = (m_oldest + 1) % m_slots.size();
+        m_pending--;
+
+        if (!mapped)
+            continue;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(std::move(frame));
+        }
+        m_queued.notify_one();
+    }
+}
+
+void FrameCapture::finish()
+{
+    if (m_bFinished)
+        return;
+
+    // Every readback left in flight has to be written
+    while (m_pending > 0)
+        collect(true);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bStop = true;
+    }
+    m_queued.notify_one();
+    m_thread.join();
+    m_bFinished = true;
+}
+
+int FrameCapture::getFrameCount() const
+{
+    return m_frameCount;
+}
+
+void FrameCapture::writerLoop()
+{
+    while (true)
+    {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queued.wait(lock, [this] { return m_bStop || !m_queue.empty(); });
+            if (m_queue.empty())
+                return;
+            frame = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        m_writer(frame.pixels.data(), frame.width, frame.height);
+
+        {
+            // Hand the memory back for the next frame
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_free.push_back(std::move(frame.pixels));
+        }
+        m_written.notify_one();
+    }
+}
+
+FrameCapture::Writer FrameCapture::rawFile(const std::string& path)
+{
+    std::shared_ptr<FILE> file(fopen(path.c_str(), "wb"), [](FILE* f) { if (f) fclose(f); });
+    if (!file)
+        printf("Could not open %s for writing\n", path.c_str());
+
+    return [file](const unsigned char* pixels, int width, int height)
+    {
+        if (file)
+            fwrite(pixels, 1, (size_t)width * height * 4, file.get());
+    };
+}
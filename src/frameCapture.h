@@ -0,0 +1,85 @@
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include <glad/glad.h>
+
+/*
+    Reads rendered frames back without stalling the render loop.
+
+    capture() starts a glReadPixels into the next pixel pack buffer of a small ring
+    and puts a fence behind it. The buffer is mapped a few frames later, once the
+    fence has signalled, so the copy never waits on the GPU. The pixels go to a writer
+    thread that hands them to the Writer callback in capture order. The render thread
+    only waits if the GPU falls a whole ring behind, or if the writer falls more than
+    MAX_QUEUED frames behind.
+
+    Frames are RGBA, top row first.
+*/
+class FrameCapture
+{
+public:
+    // Called on the writer thread for every frame
+    using Writer = std::function<void(const unsigned char* pixels, int width, int height)>;
+
+    FrameCapture(Writer writer, int buffers = 3);
+    ~FrameCapture();
+
+    // Queues a readback of the bound read framebuffer, call before presenting
+    void capture(int width, int height);
+
+    // Waits for every captured frame to be written, then stops the writer thread
+    void finish();
+
+    int getFrameCount() const;
+
+    // Writes frames back to back as raw RGBA, e.g. for ffmpeg -f rawvideo -pix_fmt rgba
+    static Writer rawFile(const std::string& path);
+
+private:
+    static const int MAX_QUEUED = 8;
+
+    struct Slot
+    {
+        GLuint buffer;
+        GLsync fence;
+        int    width;
+        int    height;
+    };
+
+    struct Frame
+    {
+        std::vector<unsigned char> pixels;
+        int width;
+        int height;
+    };
+
+    std::vector<Slot> m_slots;
+    int m_next;     // slot the next capture goes into
+    int m_oldest;   // oldest slot still waiting on its fence
+    int m_pending;
+    int m_frameCount;
+
+    Writer m_writer;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_queued;
+    std::condition_variable m_written;
+    std::deque<Frame> m_queue;
+    std::vector<std::vector<unsigned char>> m_free;
+    bool m_bStop;
+    bool m_bFinished;
+
+    // Copies finished readbacks to the writer, wait blocks on the oldest fence
+    void collect(bool wait);
+    void writerLoop();
+};
+
+#endif
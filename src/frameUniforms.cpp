@@ -0,0 +1,32 @@
+#include "frameUniforms.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "camera.h"
+
+FrameUniforms::FrameUniforms()
+    : m_data{}
+    , m_UBO(sizeof(Data), BINDING)
+{
+    m_data.scale = 1.0f;
+}
+
+void FrameUniforms::resize(glm::vec2 viewport)
+{
+    m_data.viewport   = viewport;
+    m_data.projection = glm::perspective(glm::radians(90.0f), viewport.x / viewport.y, 0.1f, 1000.0f);
+}
+
+void FrameUniforms::setScale(float scale)
+{
+    m_data.scale = scale;
+}
+
+void FrameUniforms::update(Camera* camera, float time)
+{
+    m_data.view           = camera->createViewMatrix();
+    m_data.viewProjection = m_data.projection * m_data.view;
+    m_data.time           = time;
+
+    m_UBO.setData(&m_data, sizeof(Data));
+}
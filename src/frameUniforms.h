@@ -0,0 +1,58 @@
+#ifndef FRAMEUNIFORMS_H
+#define FRAMEUNIFORMS_H
+
+#include "gl/glObjects.h"
+
+class Camera;
+
+/*
+    Per frame uniform buffer shared by every program that includes
+    assets/shaders/frame.glsl, the only declaration of the block:
+
+        layout(std140) uniform Frame
+        {
+            mat4  view;
+            mat4  projection;
+            mat4  viewProjection;
+            vec2  viewport;
+            float time;
+            float scale;
+        };
+
+    The matrices are computed once per frame (the projection only on resize) and
+    uploaded once, programs bind the block with Shader::bindUniformBlock("Frame", BINDING).
+    Positions stay in screen pixels (viewport), scale is target pixels per screen pixel
+    for the few shaders that work in pixels of the render target.
+*/
+class FrameUniforms
+{
+public:
+    static const GLuint BINDING = 0;
+
+    FrameUniforms();
+
+    // Recomputes the projection for a new viewport size (window resize)
+    void resize(glm::vec2 viewport);
+    // Render target resolution relative to the viewport, 1 unless dynamic resolution is on
+    void setScale(float scale);
+
+    // Computes the view from the camera and uploads the whole block
+    void update(Camera* camera, float time);
+
+private:
+    // std140 layout of the Frame block
+    struct Data
+    {
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::mat4 viewProjection;
+        glm::vec2 viewport;
+        float     time;
+        float     scale;
+    };
+
+    Data              m_data;
+    gl::UniformBuffer m_UBO;
+};
+
+#endif
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cstring>
+#include <algorithm>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -12,21 +14,132 @@
 
 namespace gl
 {
+    /*
+        Shadow copy of the bound GL state. Every wrapper in this file binds through it,
+        so a bind of what is already bound is dropped instead of reaching the driver,
+        and Unbind() of programs and VAOs no longer has to reset them to 0 between draws.
+        Code that talks to GL directly (e.g. gltext) must call invalidate() afterwards.
+        Element array buffers are VAO state and are always passed through.
+    */
+    class StateCache
+    {
+    public:
+        // Calls that reached GL and calls that were dropped
+        struct Counters
+        {
+            int issued = 0;
+            int elided = 0;
+        };
+
+        static StateCache& get();
+
+        void useProgram(GLuint program);
+        void bindVertexArray(GLuint VAO);
+        void bindBuffer(GLenum target, GLuint buffer);
+        void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+        // Binds on the active unit, or on unit (which becomes active)
+        void bindTexture(GLenum target, GLuint texture);
+        void bindTexture(int unit, GLenum target, GLuint texture);
+
+        // GL_BLEND, GL_DEPTH_TEST and GL_CULL_FACE are tracked, other caps are passed through
+        void setEnabled(GLenum cap, bool enabled);
+        void blendFunc(GLenum src, GLenum dst);
+        void depthMask(bool write);
+
+        // Deleted names may be recycled by GL, so they must not look bound anymore
+        void forgetProgram(GLuint program);
+        void forgetVertexArray(GLuint VAO);
+        void forgetBuffer(GLuint buffer);
+        void forgetTexture(GLuint texture);
+
+        // Forget everything, the next call of each kind reaches GL
+        void invalidate();
+
+        // Closes the frame, lastFrame() holds its counters
+        void endFrame();
+        const Counters& lastFrame() const { return m_lastFrame; }
+
+    private:
+        static const GLuint UNKNOWN = 0xFFFFFFFF;
+        static const int MAX_UNITS   = 16;
+        enum { BUFFER_TARGETS = 6, TEXTURE_TARGETS = 3, CAPS = 3 };
+
+        StateCache();
+
+        // True (and counted as issued) when value differs from the cached one
+        bool change(GLuint& cached, GLuint value);
+
+        static int bufferIndex(GLenum target);
+        static int textureIndex(GLenum target);
+        static int capIndex(GLenum cap);
+
+        GLuint m_program;
+        GLuint m_VAO;
+        GLuint m_buffers[BUFFER_TARGETS];
+        GLuint m_activeUnit;
+        GLuint m_textures[MAX_UNITS][TEXTURE_TARGETS];
+        GLuint m_caps[CAPS];
+        GLuint m_blendSrc, m_blendDst;
+        GLuint m_depthMask;
+
+        Counters m_frame;
+        Counters m_lastFrame;
+    };
+};
+
+namespace gl
+{
+    // Active uniform of a linked program as reported by glGetActiveUniform
+    struct UniformInfo
+    {
+        std::string name;
+        GLint       location;
+        GLenum      type;
+        GLint       size;
+    };
+
     class Shader
     {
     public:
         Shader();
         ~Shader();
 
+        // Loads fileName.vert and fileName.frag
         void createProgram(const std::string& fileName);
+        // For stages shared between programs, like the full screen triangle
+        void createProgram(const std::string& vertexPath, const std::string& fragmentPath);
 
         void Bind();
         void Unbind();
 
         void setAttribute(int attributeID, std::string var_name);
-        void setUniformLocation(std::string uniform_name);
+        void setUniformLocation(const std::string& uniform_name);
+
+        // Vertex shader outputs captured by transform feedback (interleaved, in this order),
+        // like attributes they must be set before createProgram
+        void setFeedbackVaryings(const std::vector<std::string>& varyings);
+
+        // Connects a uniform block of the linked program to a UniformBuffer binding point
+        void bindUniformBlock(const std::string& block_name, GLuint binding);
+
+        // String lookup, meant for setup code (hot paths use handles)
+        int getUniformLocation(const std::string& uniform_name);
 
-        int getUniformLocation(std::string uniform_name);
+        /*
+            Uniform handles: the locations of names are resolved once after linking,
+            handle i is names[i], so the names are listed in the order of an enum of
+            the owning class. uniform(handle) is a plain array read, loading a uniform
+            through it neither allocates nor compares strings.
+        */
+        void resolveUniforms(const char* const* names, int count);
+        template<size_t N>
+        void resolveUniforms(const char* const (&names)[N]) { resolveUniforms(names, (int)N); }
+
+        GLint uniform(int handle) const { return m_handles[handle]; }
+
+        // Optional reflection pass, every active uniform outside of uniform blocks
+        std::vector<UniformInfo> reflectUniforms() const;
 
         void loadFloat(int location, float value);
         void loadVector2(int location, glm::vec2 vector);
@@ -36,16 +149,83 @@ namespace gl
         void loadMatrix(int location, const glm::mat4x4& matrix);
 
     private:
-        static const unsigned int NUM_SHADERS = 2;
-
         std::vector<std::pair<int, std::string>> m_attributes;
+        std::vector<std::string> m_feedbackVaryings;
         std::map<std::string, int> m_uniformLocations;
+        std::vector<GLint>         m_handles;
+
+        static const int MAX_INCLUDE_DEPTH = 4;
 
         GLuint CreateShader(const std::string& text, unsigned int type);
-        std::string LoadShader(const std::string& fileName);
+        // Reads a source file, lines of the form #include "file" are replaced by that file
+        std::string LoadShader(const std::string& fileName, int depth = 0);
 
         GLuint m_program;
-        GLuint m_shaders[NUM_SHADERS];
+    };
+};
+
+namespace gl
+{
+    /*
+        Linked programs by everything that went into linking them: the sources, attribute
+        locations and feedback varyings. Shaders with an identical key share one program
+        (reference counted), so uniform values are shared as well and are set before each
+        draw like everywhere else.
+
+        Once enabled with a directory, every newly linked program is also stored there as
+        a driver binary (glGetProgramBinary) and loaded on the next run instead of being
+        compiled. The file name hashes the key together with the vendor, renderer and
+        version strings, so another GPU or driver update never sees an old binary, and a
+        binary the driver rejects anyway falls back to compiling and is written again.
+
+        Program binaries are GL 4.1 / ARB_get_program_binary, outside of the 3.3 loader,
+        so enable() looks the functions up through the loader of the context and only
+        turns the disk cache on when the driver reports at least one binary format.
+    */
+    class ProgramCache
+    {
+    public:
+        static ProgramCache& get();
+
+        // Turns the disk cache on, directory must exist and end with a separator
+        void enable(const std::string& directory, void* (*loader)(const char*));
+
+        // The program linked for key with a reference added, 0 when it has to be linked
+        GLuint acquire(const std::string& key);
+        // Adds a program linked by the caller (with one reference) and stores its binary
+        void insert(const std::string& key, GLuint program);
+        // Drops a reference, the program is deleted with the last one
+        void release(GLuint program);
+
+        // Call right before glLinkProgram, lets the driver keep the binary retrievable
+        void prepareLink(GLuint program);
+
+    private:
+        typedef void (APIENTRYP GetProgramBinaryProc)(GLuint, GLsizei, GLsizei*, GLenum*, void*);
+        typedef void (APIENTRYP ProgramBinaryProc)(GLuint, GLenum, const void*, GLsizei);
+        typedef void (APIENTRYP ProgramParameteriProc)(GLuint, GLenum, GLint);
+
+        struct Entry
+        {
+            GLuint program;
+            int    references;
+        };
+
+        ProgramCache();
+
+        // Binary file of key, empty while the disk cache is off
+        std::string path(const std::string& key) const;
+        GLuint load(const std::string& key);
+        void store(const std::string& key, GLuint program);
+
+        std::map<std::string, Entry> m_programs;
+        std::map<GLuint, std::string> m_keys;
+
+        std::string m_directory;
+        std::string m_driver;
+        GetProgramBinaryProc  m_getProgramBinary;
+        ProgramBinaryProc     m_programBinary;
+        ProgramParameteriProc m_programParameteri;
     };
 };
 
@@ -74,6 +254,75 @@ namespace gl
 
         void setData(const std::vector<GLfloat>& data, int attributeID, int size, int DrawMode = GL_STATIC_DRAW);
         void setSubData(const std::vector<GLfloat>& data);
+
+        // Raw upload for interleaved (e.g. per-instance) data, the previous storage is orphaned
+        void setData(const void* data, GLsizeiptr bytes, int DrawMode = GL_STREAM_DRAW);
+
+        // Float attribute inside interleaved data, divisor 1 advances it per instance instead of per vertex
+        void setAttribute(int attributeID, int size, int stride, size_t offset, int divisor = 0);
+    };
+};
+
+namespace gl
+{
+    /*
+        Buffer for data that changes every frame. The storage is split into N regions
+        that are written round-robin with glMapBufferRange(GL_MAP_UNSYNCHRONIZED_BIT), a
+        fence placed after each region is consumed makes sure a region is only rewritten
+        once the GPU is done with it, so uploads never stall on in-flight draws.
+
+        Usage: offset = write(data, count), then point attributes (or a pixel upload)
+        at offset and issue the draw that reads it before the next write.
+    */
+    struct StreamBuffer
+    {
+        StreamBuffer(GLenum target = GL_ARRAY_BUFFER, int regions = 3);
+        ~StreamBuffer();
+
+        // Maps bytes in the next region for writing, unmap returns their offset in the buffer
+        void*    map(GLsizeiptr bytes);
+        GLintptr unmap();
+
+        // Copies count elements (e.g. straight from an analysis output array) into the next region
+        template<typename T>
+        GLintptr write(const T* data, size_t count);
+
+        // Float attribute at offset inside the buffer (instanced when divisor is 1)
+        void setAttribute(int attributeID, int size, int stride, GLintptr offset, int divisor = 0);
+
+        GLuint buffer;
+        GLenum target;
+
+    private:
+        std::vector<GLsync> m_fences;
+        int        m_region;
+        bool       m_written;
+        GLsizeiptr m_regionSize;
+
+        void reserve(GLsizeiptr bytes);
+        void waitRegion(int region);
+    };
+
+    template<typename T>
+    GLintptr StreamBuffer::write(const T* data, size_t count)
+    {
+        void* ptr = map(sizeof(T) * count);
+        memcpy(ptr, data, sizeof(T) * count);
+        return unmap();
+    }
+};
+
+namespace gl
+{
+    struct UniformBuffer
+    {
+        UniformBuffer(GLsizeiptr size, GLuint binding);
+        ~UniformBuffer();
+
+        void setData(const void* data, GLsizeiptr size, GLintptr offset = 0);
+
+        GLuint UBO;
+        GLuint binding;
     };
 };
 
@@ -107,6 +356,171 @@ namespace gl
     };
 };
 
+namespace gl
+{
+    /*
+        1D float texture holding one value per texel (e.g. a spectrum or per-bar colours) for
+        shaders to read with texelFetch. Uploads go through a streaming pixel unpack
+        buffer so updating it every frame doesn't wait on draws still reading it.
+    */
+    struct DataTexture1D
+    {
+        DataTexture1D(GLenum internalFormat = GL_R32F, GLenum format = GL_RED, int texelSize = sizeof(GLfloat));
+        ~DataTexture1D();
+
+        // Uploads count texels, the texture is reallocated when count changes
+        void setData(const void* data, int count);
+        void bind(int unit);
+
+        // GL_NEAREST by default, GL_LINEAR for lookup tables
+        void setFilter(GLenum filter);
+
+        GLuint texture;
+        int    width;
+
+    private:
+        GLenum m_internalFormat;
+        GLenum m_format;
+        int    m_texelSize;
+        StreamBuffer m_upload;
+    };
+};
+
+namespace gl
+{
+    /*
+        2D float texture used as a ring buffer of lines (e.g. one spectrum per analysis
+        frame). pushLine uploads only the new line over the oldest one with
+        glTexSubImage2D, head is the row that was written last, so the history is read
+        backwards from head in the shader with wrap-around.
+    */
+    struct RingTexture2D
+    {
+        RingTexture2D(int rows, GLenum internalFormat = GL_R32F, GLenum format = GL_RED, int texelSize = sizeof(GLfloat));
+        ~RingTexture2D();
+
+        // Writes width texels as the newest row, the history is cleared when width changes
+        void pushLine(const void* data, int width);
+        void bind(int unit);
+
+        GLuint texture;
+        int    width;
+        int    rows;
+        int    head;
+
+    private:
+        GLenum m_internalFormat;
+        GLenum m_format;
+        int    m_texelSize;
+        StreamBuffer m_upload;
+
+        void allocate(int width);
+    };
+};
+
+namespace gl
+{
+    /*
+        Offscreen render target: a colour texture plus a depth/stencil renderbuffer.
+        Used instead of the default framebuffer when there is no window (headless) and
+        for passes that sample the rendered scene afterwards. Post-process targets
+        can go without the depth buffer.
+    */
+    struct Framebuffer
+    {
+        Framebuffer(int width, int height, GLenum colourFormat = GL_RGBA8, bool depthBuffer = true);
+        ~Framebuffer();
+
+        // Reallocates the attachments, the contents are undefined afterwards
+        void resize(int width, int height);
+        // Binds for drawing and sets the viewport to the whole target
+        void bind();
+        static void unbind();
+
+        GLuint fbo;
+        GLuint colour;
+        GLuint depth;
+        int    width;
+        int    height;
+
+    private:
+        GLenum m_colourFormat;
+    };
+};
+
+namespace gl
+{
+    /*
+        GPU time of the commands between begin() and end(), from a GL_TIMESTAMP query
+        at each end. Unlike GL_TIME_ELAPSED these don't occupy a query target, so spans
+        of different timers may nest. Results are read back a few frames later and never
+        waited on, a span started while every pair is still in flight is not measured.
+    */
+    struct GpuTimer
+    {
+        GpuTimer();
+        ~GpuTimer();
+
+        void begin();
+        void end();
+        // Milliseconds of the oldest finished span, negative when none finished yet
+        float poll();
+        // Spans still in flight are never returned by poll()
+        void discard();
+
+        static const int QUERIES = 4;
+
+    private:
+        // Start and end timestamp of each span
+        GLuint m_queries[QUERIES][2];
+        bool   m_issued[QUERIES];
+        bool   m_discarded[QUERIES];
+        int    m_next;
+        bool   m_bRunning;
+    };
+
+    /*
+        Average GPU time of a span, for controllers that adjust a setting against a
+        budget (bloom quality, render scale). After a change the average starts over
+        from the first span drawn with the new setting, and is worth acting on once
+        SETTLE_FRAMES spans were measured.
+
+        A change that had to be undone is tried again after wait() frames, backoff()
+        doubles it every time that happens.
+    */
+    struct GpuTimeAverage
+    {
+        static const int SETTLE_FRAMES = 30;
+
+        GpuTimeAverage();
+
+        void begin();
+        void end();
+        // Adds the finished spans to the average, once per frame
+        void update();
+        // Counts a frame without a span (the work was skipped), so waits still run out
+        void skip();
+
+        // Milliseconds, 0 until measured
+        float get() const;
+        // Measured or skipped frames since the last change
+        int  frames() const;
+        bool settled() const;
+
+        // The setting changed, the spans still in flight belong to the old one
+        void restart();
+
+        int  wait() const;
+        void backoff();
+
+    private:
+        GpuTimer m_timer;
+        float    m_average;
+        int      m_frames;
+        int      m_wait;
+    };
+};
+
 namespace gl
 {
     struct TextureAtlas
@@ -139,6 +553,206 @@ namespace gl
 */
 #ifdef GLOBJECTS_IMPLEMENTATION
 
+//////////////////////////////
+// StateCache IMPLEMENTATION //
+//////////////////////////////
+
+gl::StateCache& gl::StateCache::get()
+{
+    static StateCache cache;
+    return cache;
+}
+
+gl::StateCache::StateCache()
+{
+    invalidate();
+}
+
+bool gl::StateCache::change(GLuint& cached, GLuint value)
+{
+    if (cached == value)
+    {
+        m_frame.elided++;
+        return false;
+    }
+
+    cached = value;
+    m_frame.issued++;
+    return true;
+}
+
+int gl::StateCache::bufferIndex(GLenum target)
+{
+    switch (target)
+    {
+        case GL_ARRAY_BUFFER:              return 0;
+        case GL_UNIFORM_BUFFER:            return 1;
+        case GL_PIXEL_PACK_BUFFER:         return 2;
+        case GL_PIXEL_UNPACK_BUFFER:       return 3;
+        case GL_COPY_READ_BUFFER:          return 4;
+        case GL_TRANSFORM_FEEDBACK_BUFFER: return 5;
+        default:                           return -1;
+    }
+}
+
+int gl::StateCache::textureIndex(GLenum target)
+{
+    switch (target)
+    {
+        case GL_TEXTURE_1D: return 0;
+        case GL_TEXTURE_2D: return 1;
+        case GL_TEXTURE_3D: return 2;
+        default:            return -1;
+    }
+}
+
+int gl::StateCache::capIndex(GLenum cap)
+{
+    switch (cap)
+    {
+        case GL_BLEND:      return 0;
+        case GL_DEPTH_TEST: return 1;
+        case GL_CULL_FACE:  return 2;
+        default:            return -1;
+    }
+}
+
+void gl::StateCache::useProgram(GLuint program)
+{
+    if (change(m_program, program))
+        glUseProgram(program);
+}
+
+void gl::StateCache::bindVertexArray(GLuint VAO)
+{
+    if (change(m_VAO, VAO))
+        glBindVertexArray(VAO);
+}
+
+void gl::StateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+    int index = bufferIndex(target);
+    if (index == -1)
+    {
+        m_frame.issued++;
+        glBindBuffer(target, buffer);
+    }
+    else if (change(m_buffers[index], buffer))
+        glBindBuffer(target, buffer);
+}
+
+void gl::StateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    // Also binds the generic target
+    m_frame.issued++;
+    glBindBufferBase(target, index, buffer);
+
+    int slot = bufferIndex(target);
+    if (slot != -1)
+        m_buffers[slot] = buffer;
+}
+
+void gl::StateCache::bindTexture(GLenum target, GLuint texture)
+{
+    int index = textureIndex(target);
+    if (index == -1 || m_activeUnit >= (GLuint)MAX_UNITS)
+    {
+        m_frame.issued++;
+        glBindTexture(target, texture);
+    }
+    else if (change(m_textures[m_activeUnit][index], texture))
+        glBindTexture(target, texture);
+}
+
+void gl::StateCache::bindTexture(int unit, GLenum target, GLuint texture)
+{
+    if (change(m_activeUnit, unit))
+        glActiveTexture(GL_TEXTURE0 + unit);
+
+    bindTexture(target, texture);
+}
+
+void gl::StateCache::setEnabled(GLenum cap, bool enabled)
+{
+    int index = capIndex(cap);
+    if (index != -1 && !change(m_caps[index], enabled))
+        return;
+    if (index == -1)
+        m_frame.issued++;
+
+    if (enabled) glEnable(cap);
+    else         glDisable(cap);
+}
+
+void gl::StateCache::blendFunc(GLenum src, GLenum dst)
+{
+    if (m_blendSrc == src && m_blendDst == dst)
+    {
+        m_frame.elided++;
+        return;
+    }
+
+    m_blendSrc = src;
+    m_blendDst = dst;
+    m_frame.issued++;
+    glBlendFunc(src, dst);
+}
+
+void gl::StateCache::depthMask(bool write)
+{
+    if (change(m_depthMask, write))
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+}
+
+void gl::StateCache::forgetProgram(GLuint program)
+{
+    if (m_program == program)
+        m_program = UNKNOWN;
+}
+
+void gl::StateCache::forgetVertexArray(GLuint VAO)
+{
+    if (m_VAO == VAO)
+        m_VAO = 0;
+}
+
+void gl::StateCache::forgetBuffer(GLuint buffer)
+{
+    for (auto& bound : m_buffers)
+        if (bound == buffer) bound = 0;
+}
+
+void gl::StateCache::forgetTexture(GLuint texture)
+{
+    for (auto& unit : m_textures)
+        for (auto& bound : unit)
+            if (bound == texture) bound = 0;
+}
+
+void gl::StateCache::invalidate()
+{
+    m_program    = UNKNOWN;
+    m_VAO        = UNKNOWN;
+    m_activeUnit = UNKNOWN;
+    m_blendSrc   = UNKNOWN;
+    m_blendDst   = UNKNOWN;
+    m_depthMask  = UNKNOWN;
+
+    for (auto& bound : m_buffers) bound = UNKNOWN;
+    for (auto& cap : m_caps)      cap   = UNKNOWN;
+    for (auto& unit : m_textures)
+        for (auto& bound : unit)
+            bound = UNKNOWN;
+}
+
+void gl::StateCache::endFrame()
+{
+    m_lastFrame = m_frame;
+    m_frame     = Counters();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////
 // SHADER IMPLEMENTATION   //
 /////////////////////////////
@@ -150,28 +764,44 @@ namespace gl
 
 gl::Shader::Shader()
 {
-    m_program = -1;
+    m_program = 0;
 }
 
 gl::Shader::~Shader()
 {
-    for (unsigned int i = 0; i < NUM_SHADERS; i++)
-    {
-        glDetachShader(m_program, m_shaders[i]);
-        glDeleteShader(m_shaders[i]);
-    }
-
-    glDeleteProgram(m_program);
+    ProgramCache::get().release(m_program);
 }
 
 void gl::Shader::createProgram(const std::string & fileName)
 {
+    createProgram(fileName + ".vert", fileName + ".frag");
+}
+
+void gl::Shader::createProgram(const std::string& vertexPath, const std::string& fragmentPath)
+{
+    std::string vertex   = LoadShader(vertexPath);
+    std::string fragment = LoadShader(fragmentPath);
+
+    // Everything that ends up in the linked program
+    std::string key = vertex + '\0' + fragment;
+    for (auto& attribute : m_attributes)
+        key += '\0' + std::to_string(attribute.first) + ' ' + attribute.second;
+    for (auto& varying : m_feedbackVaryings)
+        key += '\0' + varying;
+
+    ProgramCache& cache = ProgramCache::get();
+    m_program = cache.acquire(key);
+    if (m_program != 0)
+        return;
+
     m_program = glCreateProgram();
-    m_shaders[0] = CreateShader(LoadShader(fileName + ".vert"), GL_VERTEX_SHADER);
-    m_shaders[1] = CreateShader(LoadShader(fileName + ".frag"), GL_FRAGMENT_SHADER);
+    GLuint shaders[2] = {
+        CreateShader(vertex, GL_VERTEX_SHADER),
+        CreateShader(fragment, GL_FRAGMENT_SHADER)
+    };
 
-    for (unsigned int i = 0; i < NUM_SHADERS; i++)
-        glAttachShader(m_program, m_shaders[i]);
+    for (GLuint shader : shaders)
+        glAttachShader(m_program, shader);
 
 
     // Bind attributes
@@ -180,18 +810,36 @@ void gl::Shader::createProgram(const std::string & fileName)
         glBindAttribLocation(m_program, attribute.first, attribute.second.c_str());
     }
 
+    if (!m_feedbackVaryings.empty())
+    {
+        std::vector<const GLchar*> varyings;
+        for (auto& varying : m_feedbackVaryings)
+            varyings.push_back(varying.c_str());
+        glTransformFeedbackVaryings(m_program, (GLsizei)varyings.size(), varyings.data(), GL_INTERLEAVED_ATTRIBS);
+    }
+
+    cache.prepareLink(m_program);
     glLinkProgram(m_program);
     glValidateProgram(m_program);
+
+    // The linked program doesn't need its shaders anymore
+    for (GLuint shader : shaders)
+    {
+        glDetachShader(m_program, shader);
+        glDeleteShader(shader);
+    }
+
+    cache.insert(key, m_program);
 }
 
 void gl::Shader::Bind()
 {
-    glUseProgram(m_program);
+    StateCache::get().useProgram(m_program);
 }
 
+// Programs stay bound until the next Bind, rebinding the same one is free
 void gl::Shader::Unbind()
 {
-    glUseProgram(0);
 }
 
 void gl::Shader::setAttribute(int attributeID, std::string var_name)
@@ -199,24 +847,76 @@ void gl::Shader::setAttribute(int attributeID, std::string var_name)
     m_attributes.push_back(std::make_pair(attributeID, var_name));
 }
 
-void gl::Shader::setUniformLocation(std::string uniform_name)
+void gl::Shader::setFeedbackVaryings(const std::vector<std::string>& varyings)
+{
+    m_feedbackVaryings = varyings;
+}
+
+void gl::Shader::setUniformLocation(const std::string& uniform_name)
 {
-    if (m_program == -1)
+    if (m_program == 0)
         std::cout << "CreateProgram hasn't been called yet!\n";
 
+    // Misses are reported here once instead of on every lookup
     int location = glGetUniformLocation(m_program, uniform_name.c_str());
+    if (location == -1)
+        std::cout << "Found no location for the uniform: " << uniform_name << "\n";
+
     m_uniformLocations.insert(std::make_pair(uniform_name, location));
 }
 
-int gl::Shader::getUniformLocation(std::string uniform_name)
+void gl::Shader::bindUniformBlock(const std::string& block_name, GLuint binding)
 {
-    if (m_uniformLocations.find(uniform_name) == m_uniformLocations.end())
-    {
-        std::cout << "Found no location for the uniform: " << uniform_name << "\n";
+    GLuint index = glGetUniformBlockIndex(m_program, block_name.c_str());
+    if (index == GL_INVALID_INDEX)
+        std::cout << "Found no uniform block: " << block_name << "\n";
+    else
+        glUniformBlockBinding(m_program, index, binding);
+}
+
+int gl::Shader::getUniformLocation(const std::string& uniform_name)
+{
+    auto it = m_uniformLocations.find(uniform_name);
+    if (it == m_uniformLocations.end())
         return -1;
+
+    return it->second;
+}
+
+void gl::Shader::resolveUniforms(const char* const* names, int count)
+{
+    m_handles.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        // -1 is ignored by glUniform*, unused (optimised out) uniforms stay harmless
+        m_handles[i] = glGetUniformLocation(m_program, names[i]);
+        if (m_handles[i] == -1)
+            std::cout << "Found no location for the uniform: " << names[i] << "\n";
     }
-    else
-        return m_uniformLocations.at(uniform_name);
+}
+
+std::vector<gl::UniformInfo> gl::Shader::reflectUniforms() const
+{
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::vector<UniformInfo> uniforms;
+    std::vector<GLchar> name(maxLength > 0 ? maxLength : 1);
+    for (GLint i = 0; i < count; i++)
+    {
+        UniformInfo info;
+        GLsizei length = 0;
+        glGetActiveUniform(m_program, i, (GLsizei)name.size(), &length, &info.size, &info.type, name.data());
+        info.name.assign(name.data(), length);
+        info.location = glGetUniformLocation(m_program, info.name.c_str());
+
+        // Members of uniform blocks have no location
+        if (info.location != -1)
+            uniforms.push_back(info);
+    }
+
+    return uniforms;
 }
 
 void gl::Shader::loadFloat(int location, float value)
@@ -271,7 +971,7 @@ GLuint gl::Shader::CreateShader(const std::string & text, unsigned int type)
     return shader;
 }
 
-std::string gl::Shader::LoadShader(const std::string & fileName)
+std::string gl::Shader::LoadShader(const std::string & fileName, int depth)
 {
     std::ifstream file;
     file.open((fileName).c_str());
@@ -279,11 +979,26 @@ std::string gl::Shader::LoadShader(const std::string & fileName)
     std::string output;
     std::string line;
 
+    // #include "name" is looked up next to the including file
+    static const std::string INCLUDE = "#include \"";
+    std::string directory = fileName.substr(0, fileName.find_last_of("/\\") + 1);
+
     if (file.is_open())
     {
         while (file.good())
         {
             getline(file, line);
+
+            size_t end = line.find('"', INCLUDE.size());
+            if (line.compare(0, INCLUDE.size(), INCLUDE) == 0 && end != std::string::npos)
+            {
+                if (depth < MAX_INCLUDE_DEPTH)
+                    output.append(LoadShader(directory + line.substr(INCLUDE.size(), end - INCLUDE.size()), depth + 1));
+                else
+                    std::cerr << "Shader includes nested too deep in: " << fileName << std::endl;
+                continue;
+            }
+
             output.append(line + "\n");
         }
     }
@@ -297,6 +1012,196 @@ std::string gl::Shader::LoadShader(const std::string & fileName)
 
 /////////////////////////////////////////////////////////////////////////////
 
+////////////////////////////////////
+// ProgramCache IMPLEMENTATION    //
+////////////////////////////////////
+
+// GL 4.1 / ARB_get_program_binary, not in the 3.3 headers
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+#include <cstdio>
+#include <cstdint>
+#include <iterator>
+
+gl::ProgramCache& gl::ProgramCache::get()
+{
+    static ProgramCache cache;
+    return cache;
+}
+
+gl::ProgramCache::ProgramCache()
+    : m_getProgramBinary(nullptr)
+    , m_programBinary(nullptr)
+    , m_programParameteri(nullptr)
+{
+}
+
+void gl::ProgramCache::enable(const std::string& directory, void* (*loader)(const char*))
+{
+    m_getProgramBinary  = (GetProgramBinaryProc)loader("glGetProgramBinary");
+    m_programBinary     = (ProgramBinaryProc)loader("glProgramBinary");
+    m_programParameteri = (ProgramParameteriProc)loader("glProgramParameteri");
+
+    // The entry points can exist without any format to store
+    GLint formats = 0;
+    if (m_getProgramBinary && m_programBinary)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    glGetError();
+
+    if (formats <= 0 || directory.empty())
+    {
+        std::cout << "Program binaries not supported, shaders are compiled every run\n";
+        m_directory.clear();
+        return;
+    }
+
+    m_directory = directory;
+    m_driver = std::string((const char*)glGetString(GL_VENDOR)) + '\0'
+        + (const char*)glGetString(GL_RENDERER) + '\0'
+        + (const char*)glGetString(GL_VERSION);
+}
+
+GLuint gl::ProgramCache::acquire(const std::string& key)
+{
+    auto it = m_programs.find(key);
+    if (it != m_programs.end())
+    {
+        it->second.references++;
+        return it->second.program;
+    }
+
+    GLuint program = load(key);
+    if (program != 0)
+    {
+        m_programs[key] = { program, 1 };
+        m_keys[program] = key;
+    }
+    return program;
+}
+
+void gl::ProgramCache::insert(const std::string& key, GLuint program)
+{
+    m_programs[key] = { program, 1 };
+    m_keys[program] = key;
+    store(key, program);
+}
+
+void gl::ProgramCache::release(GLuint program)
+{
+    auto key = m_keys.find(program);
+    if (key == m_keys.end())
+        return;
+
+    auto it = m_programs.find(key->second);
+    if (--it->second.references > 0)
+        return;
+
+    m_programs.erase(it);
+    m_keys.erase(key);
+    glDeleteProgram(program);
+    StateCache::get().forgetProgram(program);
+}
+
+void gl::ProgramCache::prepareLink(GLuint program)
+{
+    if (!m_directory.empty() && m_programParameteri)
+        m_programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+std::string gl::ProgramCache::path(const std::string& key) const
+{
+    if (m_directory.empty())
+        return std::string();
+
+    // 64 bit FNV-1a of the key and the driver
+    uint64_t hash = 14695981039346656037ull;
+    for (const std::string* part : { &key, &m_driver })
+    {
+        for (unsigned char c : *part)
+        {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)hash);
+    return m_directory + name;
+}
+
+GLuint gl::ProgramCache::load(const std::string& key)
+{
+    std::string file = path(key);
+    if (file.empty())
+        return 0;
+
+    std::ifstream reader(file, std::ios::binary);
+    if (!reader.is_open())
+        return 0;
+
+    // The binary format followed by the binary
+    GLenum format = 0;
+    if (!reader.read((char*)&format, sizeof(format)))
+        return 0;
+    std::vector<char> binary((std::istreambuf_iterator<char>(reader)), std::istreambuf_iterator<char>());
+    if (binary.empty())
+        return 0;
+
+    GLuint program = glCreateProgram();
+    m_programBinary(program, format, binary.data(), (GLsizei)binary.size());
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        glDeleteProgram(program);
+        glGetError();
+        return 0;
+    }
+
+    return program;
+}
+
+void gl::ProgramCache::store(const std::string& key, GLuint program)
+{
+    std::string file = path(key);
+    if (file.empty())
+        return;
+
+    GLint linked = GL_FALSE, length = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (!linked || length <= 0)
+        return;
+
+    GLenum format = 0;
+    std::vector<char> binary(length);
+    m_getProgramBinary(program, length, &length, &format, binary.data());
+
+    // Written under a temporary name so a reader never sees half a file
+    std::string temporary = file + ".tmp";
+    std::ofstream writer(temporary, std::ios::binary);
+    writer.write((const char*)&format, sizeof(format));
+    writer.write(binary.data(), length);
+    writer.close();
+
+    if (writer.fail() || std::rename(temporary.c_str(), file.c_str()) != 0)
+    {
+        std::cout << "Could not write the program binary " << file << "\n";
+        std::remove(temporary.c_str());
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////
 //    VAO IMPLEMENTATION    //
 /////////////////////////////
@@ -309,16 +1214,17 @@ gl::VertexArray::VertexArray()
 gl::VertexArray::~VertexArray()
 {
     glDeleteVertexArrays(1, &VAO);
+    StateCache::get().forgetVertexArray(VAO);
 }
 
 void gl::VertexArray::Bind()
 {
-    glBindVertexArray(VAO);
+    StateCache::get().bindVertexArray(VAO);
 }
 
+// Stays bound until the next Bind, every VAO setup and draw binds its own first
 void gl::VertexArray::Unbind()
 {
-    glBindVertexArray(0);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -335,24 +1241,168 @@ gl::VertexBufferObject::VertexBufferObject()
 gl::VertexBufferObject::~VertexBufferObject()
 {
     glDeleteBuffers(1, &VBO);
+    StateCache::get().forgetBuffer(VBO);
 }
 
 void gl::VertexBufferObject::setData(const std::vector<GLfloat>& data, int attributeID, int size, int DrawMode)
 {
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    StateCache::get().bindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * data.size(), data.data(), DrawMode);
 
     glEnableVertexAttribArray(attributeID);
     glVertexAttribPointer(attributeID, size, GL_FLOAT, false, 0, 0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    StateCache::get().bindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void gl::VertexBufferObject::setSubData(const std::vector<GLfloat>& data)
 {
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    StateCache::get().bindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(GLfloat) * data.size(), data.data());
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    StateCache::get().bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void gl::VertexBufferObject::setData(const void* data, GLsizeiptr bytes, int DrawMode)
+{
+    StateCache::get().bindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, bytes, data, DrawMode);
+    StateCache::get().bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void gl::VertexBufferObject::setAttribute(int attributeID, int size, int stride, size_t offset, int divisor)
+{
+    StateCache::get().bindBuffer(GL_ARRAY_BUFFER, VBO);
+
+    glEnableVertexAttribArray(attributeID);
+    glVertexAttribPointer(attributeID, size, GL_FLOAT, false, stride, (const void*)offset);
+    glVertexAttribDivisor(attributeID, divisor);
+
+    StateCache::get().bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////
+// StreamBuffer IMPLEMENTATION   //
+///////////////////////////////////
+
+gl::StreamBuffer::StreamBuffer(GLenum target, int regions)
+    : target(target)
+    , m_fences(regions, nullptr)
+    , m_region(0)
+    , m_written(false)
+    , m_regionSize(0)
+{
+    glGenBuffers(1, &buffer);
+}
+
+gl::StreamBuffer::~StreamBuffer()
+{
+    for (auto& fence : m_fences)
+        glDeleteSync(fence);
+
+    glDeleteBuffers(1, &buffer);
+    StateCache::get().forgetBuffer(buffer);
+}
+
+void* gl::StreamBuffer::map(GLsizeiptr bytes)
+{
+    // Everything issued since the last write consumed that region, fence it and move on
+    if (m_written)
+    {
+        glDeleteSync(m_fences[m_region]);
+        m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_region = (m_region + 1) % m_fences.size();
+    }
+    m_written = true;
+
+    reserve(bytes);
+    waitRegion(m_region);
+
+    StateCache::get().bindBuffer(target, buffer);
+    return glMapBufferRange(target, m_region * m_regionSize, bytes,
+        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+}
+
+GLintptr gl::StreamBuffer::unmap()
+{
+    glUnmapBuffer(target);
+    StateCache::get().bindBuffer(target, 0);
+    return m_region * m_regionSize;
+}
+
+void gl::StreamBuffer::setAttribute(int attributeID, int size, int stride, GLintptr offset, int divisor)
+{
+    StateCache::get().bindBuffer(GL_ARRAY_BUFFER, buffer);
+
+    glEnableVertexAttribArray(attributeID);
+    glVertexAttribPointer(attributeID, size, GL_FLOAT, false, stride, (const void*)offset);
+    glVertexAttribDivisor(attributeID, divisor);
+
+    StateCache::get().bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void gl::StreamBuffer::reserve(GLsizeiptr bytes)
+{
+    if (bytes <= m_regionSize)
+        return;
+
+    // Grow to the next multiple of 64KB, orphaning the old storage (the GPU keeps it
+    // alive until pending draws are done) so the old fences are no longer needed
+    m_regionSize = (bytes + 0xFFFF) & ~(GLsizeiptr)0xFFFF;
+
+    StateCache::get().bindBuffer(target, buffer);
+    glBufferData(target, m_regionSize * m_fences.size(), nullptr, GL_STREAM_DRAW);
+    StateCache::get().bindBuffer(target, 0);
+
+    for (auto& fence : m_fences)
+    {
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+}
+
+void gl::StreamBuffer::waitRegion(int region)
+{
+    GLsync fence = m_fences[region];
+    if (!fence)
+        return;
+
+    // Normally already signaled since the region was used N writes ago
+    while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+
+    glDeleteSync(fence);
+    m_fences[region] = nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////
+//    UBO IMPLEMENTATION    //
+/////////////////////////////
+gl::UniformBuffer::UniformBuffer(GLsizeiptr size, GLuint binding)
+    : binding(binding)
+{
+    glGenBuffers(1, &UBO);
+    StateCache::get().bindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    StateCache::get().bindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // Stays bound to its binding point, programs only refer to the index
+    StateCache::get().bindBufferBase(GL_UNIFORM_BUFFER, binding, UBO);
+}
+
+gl::UniformBuffer::~UniformBuffer()
+{
+    glDeleteBuffers(1, &UBO);
+    StateCache::get().forgetBuffer(UBO);
+}
+
+void gl::UniformBuffer::setData(const void* data, GLsizeiptr size, GLintptr offset)
+{
+    StateCache::get().bindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    StateCache::get().bindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -368,11 +1418,12 @@ gl::ElementArrayBuffer::ElementArrayBuffer()
 gl::ElementArrayBuffer::~ElementArrayBuffer()
 {
     glDeleteBuffers(1, &EBO);
+    StateCache::get().forgetBuffer(EBO);
 }
 
 void gl::ElementArrayBuffer::setData(const std::vector<GLuint>& indicies, int DrawMode)
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    StateCache::get().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indicies.size(), indicies.data(), DrawMode);
 
     size = indicies.size();
@@ -380,7 +1431,7 @@ void gl::ElementArrayBuffer::setData(const std::vector<GLuint>& indicies, int Dr
 
 void gl::ElementArrayBuffer::setSubData(const std::vector<GLuint>& indicies)
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    StateCache::get().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
     glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, sizeof(GLuint) * indicies.size(), indicies.data());
 
     size = indicies.size();
@@ -404,6 +1455,7 @@ gl::Texture::Texture(std::string texture_path)
 gl::Texture::~Texture()
 {
     glDeleteTextures(1, &texture);
+    StateCache::get().forgetTexture(texture);
 }
 
 void gl::Texture::loadTexture(std::string texture_path)
@@ -419,7 +1471,7 @@ void gl::Texture::loadTexture(std::string texture_path)
     else
     {
         glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
+        StateCache::get().bindTexture(GL_TEXTURE_2D, texture);
 
         // Send texture data to the GPU
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
@@ -437,10 +1489,364 @@ void gl::Texture::loadTexture(std::string texture_path)
 
 void gl::Texture::activateAndBind()
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    StateCache::get().bindTexture(0, GL_TEXTURE_2D, texture);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////
+// DataTexture1D IMPLEMENTATION   //
+////////////////////////////////////
+gl::DataTexture1D::DataTexture1D(GLenum internalFormat, GLenum format, int texelSize)
+    : width(0)
+    , m_internalFormat(internalFormat)
+    , m_format(format)
+    , m_texelSize(texelSize)
+    , m_upload(GL_PIXEL_UNPACK_BUFFER)
+{
+    glGenTextures(1, &texture);
+    StateCache::get().bindTexture(GL_TEXTURE_1D, texture);
+
+    // Values are read per texel, no filtering
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    StateCache::get().bindTexture(GL_TEXTURE_1D, 0);
 }
 
+gl::DataTexture1D::~DataTexture1D()
+{
+    glDeleteTextures(1, &texture);
+    StateCache::get().forgetTexture(texture);
+}
+
+void gl::DataTexture1D::setData(const void* data, int count)
+{
+    if (count <= 0)
+        return;
+
+    GLintptr offset = m_upload.write(static_cast<const char*>(data), (size_t)count * m_texelSize);
+
+    StateCache::get().bindTexture(GL_TEXTURE_1D, texture);
+    StateCache::get().bindBuffer(GL_PIXEL_UNPACK_BUFFER, m_upload.buffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (count != width)
+    {
+        width = count;
+        glTexImage1D(GL_TEXTURE_1D, 0, m_internalFormat, width, 0, m_format, GL_FLOAT, (const void*)offset);
+    }
+    else
+        glTexSubImage1D(GL_TEXTURE_1D, 0, 0, width, m_format, GL_FLOAT, (const void*)offset);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    StateCache::get().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void gl::DataTexture1D::bind(int unit)
+{
+    StateCache::get().bindTexture(unit, GL_TEXTURE_1D, texture);
+}
+
+void gl::DataTexture1D::setFilter(GLenum filter)
+{
+    StateCache::get().bindTexture(GL_TEXTURE_1D, texture);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, filter);
+    StateCache::get().bindTexture(GL_TEXTURE_1D, 0);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////
+// RingTexture2D IMPLEMENTATION   //
+////////////////////////////////////
+gl::RingTexture2D::RingTexture2D(int rows, GLenum internalFormat, GLenum format, int texelSize)
+    : width(0)
+    , rows(rows)
+    , head(rows - 1)
+    , m_internalFormat(internalFormat)
+    , m_format(format)
+    , m_texelSize(texelSize)
+    , m_upload(GL_PIXEL_UNPACK_BUFFER)
+{
+    glGenTextures(1, &texture);
+    StateCache::get().bindTexture(GL_TEXTURE_2D, texture);
+
+    // Linear across a line, lines are fetched with wrap-around in time
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+}
+
+gl::RingTexture2D::~RingTexture2D()
+{
+    glDeleteTextures(1, &texture);
+    StateCache::get().forgetTexture(texture);
+}
+
+void gl::RingTexture2D::allocate(int newWidth)
+{
+    width = newWidth;
+    head  = rows - 1;
+
+    // Start from silence, the zeroes go through client memory once per resize
+    std::vector<char> zero((size_t)width * rows * m_texelSize, 0);
+    StateCache::get().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    StateCache::get().bindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, m_internalFormat, width, rows, 0, m_format, GL_FLOAT, zero.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void gl::RingTexture2D::pushLine(const void* data, int lineWidth)
+{
+    if (lineWidth <= 0)
+        return;
+    if (lineWidth != width)
+        allocate(lineWidth);
+
+    head = (head + 1) % rows;
+    GLintptr offset = m_upload.write(static_cast<const char*>(data), (size_t)width * m_texelSize);
+
+    StateCache::get().bindTexture(GL_TEXTURE_2D, texture);
+    StateCache::get().bindBuffer(GL_PIXEL_UNPACK_BUFFER, m_upload.buffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, head, width, 1, m_format, GL_FLOAT, (const void*)offset);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    StateCache::get().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void gl::RingTexture2D::bind(int unit)
+{
+    StateCache::get().bindTexture(unit, GL_TEXTURE_2D, texture);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////
+// Framebuffer IMPLEMENTATION     //
+////////////////////////////////////
+gl::Framebuffer::Framebuffer(int width, int height, GLenum colourFormat, bool depthBuffer)
+    : depth(0)
+    , width(0)
+    , height(0)
+    , m_colourFormat(colourFormat)
+{
+    glGenFramebuffers(1, &fbo);
+    glGenTextures(1, &colour);
+    if (depthBuffer)
+        glGenRenderbuffers(1, &depth);
+
+    StateCache::get().bindTexture(GL_TEXTURE_2D, colour);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    resize(width, height);
+}
+
+gl::Framebuffer::~Framebuffer()
+{
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(1, &colour);
+    if (depth)
+        glDeleteRenderbuffers(1, &depth);
+    StateCache::get().forgetTexture(colour);
+}
+
+void gl::Framebuffer::resize(int newWidth, int newHeight)
+{
+    if (newWidth == width && newHeight == height)
+        return;
+    width  = newWidth  > 0 ? newWidth  : 1;
+    height = newHeight > 0 ? newHeight : 1;
+
+    // Attaching needs the framebuffer bound, whatever was bound is restored after
+    GLint bound;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &bound);
+
+    StateCache::get().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    StateCache::get().bindTexture(GL_TEXTURE_2D, colour);
+    glTexImage2D(GL_TEXTURE_2D, 0, m_colourFormat, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colour, 0);
+
+    if (depth)
+    {
+        glBindRenderbuffer(GL_RENDERBUFFER, depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+    }
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Framebuffer " << width << "x" << height << " is incomplete\n";
+    glBindFramebuffer(GL_FRAMEBUFFER, bound);
+}
+
+void gl::Framebuffer::bind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+}
+
+void gl::Framebuffer::unbind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////
+// GpuTimer IMPLEMENTATION        //
+////////////////////////////////////
+gl::GpuTimer::GpuTimer()
+    : m_next(0)
+    , m_bRunning(false)
+{
+    glGenQueries(QUERIES * 2, &m_queries[0][0]);
+    std::fill(m_issued, m_issued + QUERIES, false);
+    std::fill(m_discarded, m_discarded + QUERIES, false);
+}
+
+gl::GpuTimer::~GpuTimer()
+{
+    glDeleteQueries(QUERIES * 2, &m_queries[0][0]);
+}
+
+void gl::GpuTimer::begin()
+{
+    // The next slot is still in flight, this span goes unmeasured
+    if (m_issued[m_next])
+        return;
+
+    glQueryCounter(m_queries[m_next][0], GL_TIMESTAMP);
+    m_bRunning = true;
+}
+
+void gl::GpuTimer::end()
+{
+    if (!m_bRunning)
+        return;
+
+    glQueryCounter(m_queries[m_next][1], GL_TIMESTAMP);
+    m_issued[m_next] = true;
+    m_next = (m_next + 1) % QUERIES;
+    m_bRunning = false;
+}
+
+float gl::GpuTimer::poll()
+{
+    // The slot about to be reused holds the oldest span
+    if (!m_issued[m_next])
+        return -1.0f;
+
+    // Both have to be checked, availability of one says nothing about the other
+    for (GLuint query : m_queries[m_next])
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return -1.0f;
+    }
+
+    // A discarded span still frees its slot, just not before its queries finished
+    m_issued[m_next] = false;
+    if (m_discarded[m_next])
+    {
+        m_discarded[m_next] = false;
+        return -1.0f;
+    }
+
+    GLuint64 start = 0, end = 0;
+    glGetQueryObjectui64v(m_queries[m_next][0], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(m_queries[m_next][1], GL_QUERY_RESULT, &end);
+    return end > start ? (end - start) / 1000000.0f : 0.0f;
+}
+
+void gl::GpuTimer::discard()
+{
+    for (int i = 0; i < QUERIES; i++)
+        m_discarded[i] = m_issued[i];
+
+    // Including a span that began but hasn't ended yet
+    if (m_bRunning)
+        m_discarded[m_next] = true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////
+// GpuTimeAverage IMPLEMENTATION  //
+////////////////////////////////////
+
+gl::GpuTimeAverage::GpuTimeAverage()
+    : m_average(0.0f)
+    , m_frames(0)
+    , m_wait(4 * SETTLE_FRAMES)
+{
+}
+
+void gl::GpuTimeAverage::begin()
+{
+    m_timer.begin();
+}
+
+void gl::GpuTimeAverage::end()
+{
+    m_timer.end();
+}
+
+void gl::GpuTimeAverage::update()
+{
+    float milliseconds = m_timer.poll();
+    if (milliseconds < 0.0f)
+        return;
+
+    m_average = m_average > 0.0f ? m_average * 0.9f + milliseconds * 0.1f : milliseconds;
+    m_frames++;
+}
+
+void gl::GpuTimeAverage::skip()
+{
+    m_frames++;
+}
+
+float gl::GpuTimeAverage::get() const
+{
+    return m_average;
+}
+
+int gl::GpuTimeAverage::frames() const
+{
+    return m_frames;
+}
+
+bool gl::GpuTimeAverage::settled() const
+{
+    return m_frames >= SETTLE_FRAMES;
+}
+
+void gl::GpuTimeAverage::restart()
+{
+    m_timer.discard();
+    m_average = 0.0f;
+    m_frames  = 0;
+}
+
+int gl::GpuTimeAverage::wait() const
+{
+    return m_wait;
+}
+
+void gl::GpuTimeAverage::backoff()
+{
+    m_wait = std::min(m_wait * 2, 64 * SETTLE_FRAMES);
+}
 
 /////////////////////////////////////////////////////////////////////////////
 
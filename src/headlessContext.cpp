@@ -0,0 +1,142 @@
+#include "headlessContext.h"
+
+#include <cstdio>
+#include <cstring>
+
+#ifdef VISUALISER_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+static bool hasExtension(const char* extensions, const char* name)
+{
+    if (extensions == nullptr)
+        return false;
+
+    // Whole words only, some extension names are prefixes of others
+    size_t length = strlen(name);
+    for (const char* found = strstr(extensions, name); found; found = strstr(found + length, name))
+    {
+        bool start = found == extensions || found[-1] == ' ';
+        bool end   = found[length] == ' ' || found[length] == '\0';
+        if (start && end)
+            return true;
+    }
+    return false;
+}
+#endif
+
+HeadlessContext::HeadlessContext()
+    : m_display(nullptr)
+    , m_context(nullptr)
+    , m_surface(nullptr)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+#ifdef VISUALISER_EGL
+    if (m_display == nullptr)
+        return;
+
+    eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (m_surface) eglDestroySurface(m_display, m_surface);
+    if (m_context) eglDestroyContext(m_display, m_context);
+    eglTerminate(m_display);
+#endif
+}
+
+bool HeadlessContext::create()
+{
+#ifdef VISUALISER_EGL
+    // Prefer the surfaceless platform, the default display may try to reach an X server
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay && hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+        m_display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (m_display == EGL_NO_DISPLAY)
+        m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (m_display == EGL_NO_DISPLAY || !eglInitialize(m_display, &major, &minor))
+    {
+        printf("Couldn't initialize EGL (error 0x%x)\n", eglGetError());
+        m_display = nullptr;
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        printf("EGL doesn't support desktop OpenGL\n");
+        return false;
+    }
+
+    // Without surfaceless contexts a tiny pbuffer is made current instead
+    bool surfaceless = hasExtension(eglQueryString(m_display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+
+    const EGLint configAttributes[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_SURFACE_TYPE,    surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(m_display, configAttributes, &config, 1, &configCount) || configCount == 0)
+    {
+        printf("Found no EGL config for OpenGL\n");
+        return false;
+    }
+
+    // Request an OpenGL 3.3 core context, same as the windowed one
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION,       3,
+        EGL_CONTEXT_MINOR_VERSION,       3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (m_context == EGL_NO_CONTEXT)
+    {
+        printf("Failed to create OpenGL context (EGL error 0x%x)\n", eglGetError());
+        m_context = nullptr;
+        return false;
+    }
+
+    if (!surfaceless)
+    {
+        const EGLint pbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        m_surface = eglCreatePbufferSurface(m_display, config, pbufferAttributes);
+        if (m_surface == EGL_NO_SURFACE)
+        {
+            printf("Failed to create EGL pbuffer (error 0x%x)\n", eglGetError());
+            m_surface = nullptr;
+            return false;
+        }
+    }
+
+    EGLSurface surface = m_surface ? m_surface : EGL_NO_SURFACE;
+    if (!eglMakeCurrent(m_display, surface, surface, m_context))
+    {
+        printf("Failed to make the EGL context current (error 0x%x)\n", eglGetError());
+        return false;
+    }
+
+    printf("[EGL %d.%d, %s]\n", major, minor, surfaceless ? "surfaceless" : "pbuffer");
+    return true;
+#else
+    printf("Headless rendering needs a build with EGL\n");
+    return false;
+#endif
+}
+
+void* HeadlessContext::getProcAddress(const char* name)
+{
+#ifdef VISUALISER_EGL
+    return (void*)eglGetProcAddress(name);
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,34 @@
+#ifndef HEADLESSCONTEXT_H
+#define HEADLESSCONTEXT_H
+
+/*
+    OpenGL 3.3 core context without a window, created through EGL so it runs on
+    build servers without a display or GPU (Mesa llvmpipe).
+
+    The display comes from the surfaceless platform (EGL_MESA_platform_surfaceless)
+    when the driver offers it, otherwise the default display. The context is made
+    current without a surface (EGL_KHR_surfaceless_context) or on a 1x1 pbuffer, so
+    everything has to be drawn into a framebuffer object.
+
+    Only available when built with EGL (VISUALISER_EGL), create() fails otherwise.
+*/
+class HeadlessContext
+{
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    // Creates the context and makes it current, false if EGL couldn't provide one
+    bool create();
+
+    // Function loader for glad
+    static void* getProcAddress(const char* name);
+
+private:
+    // EGLDisplay, EGLContext and EGLSurface, kept opaque so EGL stays out of the headers
+    void* m_display;
+    void* m_context;
+    void* m_surface;
+};
+
+#endif
@@ -1,15 +1,24 @@
 #include "app.h"
 
-#include <bass.h>
 #include <vector>
 #include <fstream>
 #include <list>
 
 #include "libs/json.hpp"
 
-#include "quad.h"
 #include "camera.h"
-#include "cube.h"
+#include "frameUniforms.h"
+#include "spectrumRenderer.h"
+#include "palette.h"
+#include "audio/audioBackend.h"
+#include "analyser.h"
+#include "waterfall.h"
+#include "spectrogram.h"
+#include "particles.h"
+#include "bloom.h"
+#include "dynamicResolution.h"
+#include "frameCapture.h"
+#include "videoEncoder.h"
 
 // C++17
 #ifdef _WIN32
@@ -20,31 +29,83 @@
     namespace fs = std::filesystem;
 #endif
 
+// Seconds between refreshes of the HUD measurement lines
+static const float HUD_MEASURE_PERIOD = 0.5f;
+
 class VisualiserGL : public App
 {
 public:
-    VisualiserGL(const char* title, int width, int height, nlohmann::json config)
-        : App(title, width, height)
-        , m_quad({width, height})
+    VisualiserGL(const char* title, int width, int height, nlohmann::json config, bool headless = false)
+        : App(title, width, height, headless)
         , m_config(config)
-        , m_cube({width, height})
+        , m_barPalette(paletteConfig(config["visualiser2d"], "barPalette", { { "stops", nlohmann::json::array({ config["visualiser2d"]["barColour"] }) } }))
+        , m_circlePalette(paletteConfig(config["visualiser2d"], "circlePalette", { { "stops", nlohmann::json::array({ config["visualiser2d"]["circleColour"] }) } }))
+        , m_ringPalette(paletteConfig(config["visualiser3d"], "palette", { { "hsv", config["visualiser3d"]["barHSV"] } }))
+        , m_waterfall(config["visualiser3d"].value("waterfall", nlohmann::json::object()))
+        , m_spectrogram(config.value("spectrogram", nlohmann::json::object()))
+        , m_spectrogramPalette(paletteConfig(config.value("spectrogram", nlohmann::json::object()), "palette",
+            { { "stops", { { 0, 0, 0, 255 }, { 0, 0, 160, 255 }, { 255, 0, 0, 255 }, { 255, 255, 0, 255 }, { 255, 255, 255, 255 } } }, { "byIndex", 0.0 }, { "byMagnitude", 1.0 } }))
+        , m_particlePalette(paletteConfig(config.value("particles", nlohmann::json::object()), "palette",
+            { { "stops", { { 255, 200, 80, 255 }, { 255, 80, 0, 255 } } }, { "byIndex", 1.0 }, { "byMagnitude", 0.0 } }))
+        , m_analyser(config)
     {
         m_volume = 1.0f;
+        m_audio  = AudioBackend::create(m_config);
+        m_bSilencePresented = false;
+        m_measureAge = 0.0f;
+        m_time   = 0.0f;
+        m_frame.resize({ width, height });
+
+        // The particle buffers are large, only allocate them when the layer is used
+        auto particles = m_config.value("particles", nlohmann::json::object());
+        if (particles.value("active", false))
+            m_particles = std::make_unique<ParticleSystem>(particles);
+
+        auto bloom = m_config.value("bloom", nlohmann::json::object());
+        if (bloom.value("active", false))
+            m_bloom = std::make_unique<Bloom>(bloom);
+
+        auto resolution = m_config["display"].value("dynamicResolution", nlohmann::json::object());
+        if (resolution.value("active", false))
+            m_resolution = std::make_unique<DynamicResolution>(resolution);
 
         if (m_config["display"]["fullscreen"])
             Fullscreen(true);
     }
-    ~VisualiserGL()
-    {
-        // Cleanup BASS
-        BASS_Free();
-    }
 
     void singleMode(std::string audioFilePath)
     {
         addSong(audioFilePath);
     }
 
+    // Offline render: every frame advances exactly 1 / fps of audio and goes to a .y4m,
+    // the decoded audio is written next to it as .wav
+    bool renderVideo(const std::string& videoPath, int fps)
+    {
+        if (!m_target || !VideoEncoder::validSize(ScreenWidth(), ScreenHeight()))
+        {
+            printf("Rendering video needs a headless app, width a multiple of 8 and height even\n");
+            return false;
+        }
+
+        std::string audioPath = fs::path(videoPath).replace_extension(".wav").string();
+        m_audio->record(audioPath);
+        m_video = std::make_unique<VideoEncoder>(videoPath, ScreenWidth(), ScreenHeight(), fps);
+        FixedTimestep(1.0f / fps);
+
+        // Offline frames take as long as they need, always at full resolution
+        m_resolution.reset();
+
+        printf("Rendering %dx%d at %d fps to %s and %s\n", ScreenWidth(), ScreenHeight(), fps, videoPath.c_str(), audioPath.c_str());
+        return true;
+    }
+
+    void finishVideo()
+    {
+        if (m_video)
+            m_video->finish();
+    }
+
     void playlistMode()
     {
         // Recursive search through current folder and then add them to list
@@ -79,13 +140,20 @@ public:
 private:
     virtual bool Event(SDL_Event& e) override
     {
+        // App already updated the viewport and screen size
+        if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_RESIZED)
+        {
+            m_frame.resize({ ScreenWidth(), ScreenHeight() });
+            m_bSilencePresented = false;
+        }
+
         if (GetKey(SDL_SCANCODE_UP))
         {
             m_volume += 0.05f;
             if (m_volume >= 1.0f)
                 m_volume = 1.0f;
-            
-            BASS_ChannelSetAttribute(m_handle, BASS_ATTRIB_VOL, m_volume);
+
+            m_audio->setVolume(m_volume);
         }
         else if (GetKey(SDL_SCANCODE_DOWN))
         {
@@ -93,13 +161,18 @@ private:
             if (m_volume <= 0.0f)
                 m_volume = 0.0f;
 
-            BASS_ChannelSetAttribute(m_handle, BASS_ATTRIB_VOL, m_volume);
+            m_audio->setVolume(m_volume);
         }
         else if (e.type == SDL_KEYDOWN && e.key.keysym.scancode == SDL_SCANCODE_RIGHT)
         {
             if (!m_songList.empty())
                 playNext();
         }
+        else if (e.type == SDL_KEYDOWN && e.key.keysym.scancode == SDL_SCANCODE_SPACE)
+        {
+            if (m_audio->isPaused()) m_audio->resume();
+            else                     m_audio->pause();
+        }
 
         return true;
     }
@@ -115,15 +188,32 @@ private:
         // Most modern music uses a sample rate of 44100
         m_sampleRate = m_config["bass"]["sampleRate"];
 
-        BASS_Init(m_deviceID, m_sampleRate, 0, 0, nullptr);
+        // Refresh rate while paused or silent
+        IdleFPS(m_config["display"].value("idleFPS", 10));
+
+        // Frame pacing while playing, 0 is uncapped
+        VSync(m_config["display"].value("vsync", false));
+        MaxFPS(m_config["display"].value("maxFPS", 0));
+
+        // The camera is static, the view is still rebuilt once per frame in FrameUniforms
+        const std::vector<float> cameraPos = m_config["visualiser3d"]["cameraPos"];
+        const std::vector<float> cameraRot = m_config["visualiser3d"]["cameraRot"];
+        m_camera.setPosition({ cameraPos[0], cameraPos[1], cameraPos[2] });
+        m_camera.setRotation({ cameraRot[0], cameraRot[1], cameraRot[2] });
+
+        if (!m_audio->init(m_deviceID, m_sampleRate))
+            return false;
         playNext();
         return true;
     }
 
     virtual bool Loop(float elapsed) override
     {
+        // Advance the audio clock (decode-only backends)
+        m_audio->update(elapsed);
+
         // Check for song end
-        if (BASS_ChannelIsActive(m_handle) == BASS_ACTIVE_STOPPED)
+        if (!m_audio->isActive())
         {
             if (!m_songList.empty())
                 playNext();
@@ -131,25 +221,134 @@ private:
             else return false;
         }
 
-        // Visualise
-        auto peakmaxArray = calculatePeakMaxArray();
+        // Analysis is skipped while paused or silent
+        const auto& peakmaxArray = m_analyser.analyse(*m_audio, elapsed);
+        bool silent = m_analyser.isSilent();
+
+        // Recordings need every frame at the normal rate, silence or not
+        bool recording = m_video || IsCapturing();
+        Idle(silent && !recording);
+
+        // Once the empty spectrum is on screen only a HUD change needs a new frame
+        bool hudChanged = updateHud(elapsed);
+        if (silent && m_bSilencePresented && !hudChanged && !recording)
+        {
+            SkipFrame();
+            return true;
+        }
+        m_bSilencePresented = silent;
+
+        // Only now, a skipped frame keeps showing (and saving) the last one
+        clearFrame();
+
+        // The scene may go to a smaller target, the HUD is always drawn at full resolution
+        if (m_resolution)
+        {
+            m_resolution->begin();
+            m_frame.setScale(m_resolution->getScale());
+        }
+
+        // Matrices, viewport and time for every program, uploaded once
+        m_time += elapsed;
+        m_frame.update(&m_camera, m_time);
+
+        // Visualise (one texture upload, bars are built in the shaders)
+        m_spectrum.update(peakmaxArray);
+        if (m_config.value("spectrogram", nlohmann::json::object()).value("active", false))
+        {
+            m_spectrogram.push(peakmaxArray);
+            m_spectrogram.Draw({ 0, 0 }, { ScreenWidth(), ScreenHeight() }, m_spectrogramPalette);
+        }
         if (m_config["visualiser2d"]["active"]) visualiser2d(peakmaxArray);
         if (m_config["visualiser3d"]["active"]) visualiser3d(peakmaxArray);
-        
+
+        // Sparks on beats and bass driven dust, simulated on the GPU
+        if (m_particles)
+        {
+            m_particles->update(peakmaxArray, elapsed, { ScreenWidth() / 2.0f, ScreenHeight() / 2.0f });
+            m_particles->Draw(m_particlePalette);
+        }
+
+        // Everything up to the HUD glows
+        if (m_bloom)
+            m_bloom->apply();
+
+        if (m_resolution)
+            m_resolution->end();
+
+        // Offline renders get the picture only, the HUD is for live displays
+        if (m_video)
+        {
+            m_video->encode(m_target->colour);
+            return true;
+        }
+
         // Draw info about the song and volume
-        drawText(m_audioTitle.data(), 0, 0, 1, 1, 1, 1, 1);
-        std::string volume = "Volume: " + std::to_string(m_volume);
-        drawText(volume.data(), 0, 16, 1, 1, 1, 1, 1); // scale 1 font is size 16
+        for (size_t i = 0; i < m_hud.size(); i++)
+            drawText(m_hud[i].data(), 0, i * 16, 1, 1, 1, 1, 1); // scale 1 font is size 16
+        for (size_t i = 0; i < m_measurements.size(); i++)
+            drawText(m_measurements[i].data(), 0, (m_hud.size() + i) * 16, 1, 1, 1, 1, 1);
 
         return true;
     }
 
 private:
+    // Palette settings of a visualiser, older configs only have a plain colour (fallback)
+    static nlohmann::json paletteConfig(const nlohmann::json& visualiser, const char* key, const nlohmann::json& fallback)
+    {
+        return visualiser.contains(key) ? visualiser[key] : fallback;
+    }
+
+    // Rebuilds the HUD lines, returns true if the title or volume changed. Measurements
+    // move almost every frame (even while silence plays out), so they are refreshed
+    // every HUD_MEASURE_PERIOD seconds and never cause a new frame on their own
+    bool updateHud(float elapsed)
+    {
+        std::vector<std::string> hud;
+        hud.push_back(m_audioTitle);
+        hud.push_back("Volume: " + std::to_string(m_volume) + (m_audio->isPaused() ? " (paused)" : ""));
+
+        bool changed = hud != m_hud;
+        m_hud = std::move(hud);
+
+        m_measureAge += elapsed;
+        if (m_measureAge < HUD_MEASURE_PERIOD && !m_measurements.empty())
+            return changed;
+        m_measureAge = 0.0f;
+        m_measurements.clear();
+
+        // Audio to visual offset: what is still buffered for output versus the FFT window delay
+        char latency[64];
+        snprintf(latency, sizeof(latency), "Latency: output %.1f ms, analysis %.1f ms",
+            m_audio->getOutputLatency() * 1000.0f, m_analyser.getLatency() * 1000.0f);
+        m_measurements.push_back(latency);
+
+        if (m_bloom)
+        {
+            char bloom[64];
+            if (m_bloom->getQuality() == Bloom::QUALITY_OFF)
+                snprintf(bloom, sizeof(bloom), "Bloom: off, over budget");
+            else
+                snprintf(bloom, sizeof(bloom), "Bloom: %.1f ms (quality %d)", m_bloom->getCost(), m_bloom->getQuality());
+            m_measurements.push_back(bloom);
+        }
+
+        if (m_resolution)
+        {
+            char resolution[64];
+            snprintf(resolution, sizeof(resolution), "Resolution: %.0f%% (%.1f ms)", m_resolution->getScale() * 100.0f, m_resolution->getFrameTime());
+            m_measurements.push_back(resolution);
+        }
+
+        return changed;
+    }
+
     void playNext()
     {
         if (!m_songList.empty())
         {
-            PlayAudio(m_songList.front(), &m_handle);
+            m_audio->play(m_songList.front());
+            m_audio->setVolume(m_volume);
 
             // Get audio file title (sets the variable m_audioTitle and returns it)
             getAudioFileName(m_songList.front());
@@ -166,20 +365,6 @@ private:
         m_songList.push_back(songPath);
     }
 
-    void PlayAudio(std::string path, HSTREAM* streamHandle)
-    {
-        // Stop any previous audio from playing (also it clears the buffer by stopping it)
-        BASS_ChannelStop(*streamHandle);
-        BASS_StreamFree(*streamHandle); // Important! memory leak otherwise
-
-        *streamHandle = BASS_StreamCreateFile(false, path.data(), 0, 0, 0);
-
-        if (!BASS_ChannelPlay(*streamHandle, false))
-            printf("Could not load audio file... %s\n", path.c_str());
-        else
-            printf("Now playing... %s\n", path.c_str());
-    }
-
     // Returns audio file name from path and stores it in m_audioTitle as well
     std::string getAudioFileName(std::string path)
     {
@@ -197,90 +382,17 @@ private:
         return m_audioTitle;
     }
 
-    glm::vec4 HSVtoRGB(float H, float S, float V) {
-        if (H > 360 || H < 0 || S>100 || S < 0 || V>100 || V < 0) {
-            printf("The given HSV values are not in valid range!\n");
-        }
-        float s = S / 100;
-        float v = V / 100;
-        float C = s * v;
-        float X = C * (1 - abs(fmod(H / 60.0, 2) - 1));
-        float m = v - C;
-        float r, g, b;
-        if (H >= 0 && H < 60) {
-            r = C, g = X, b = 0;
-        }
-        else if (H >= 60 && H < 120) {
-            r = X, g = C, b = 0;
-        }
-        else if (H >= 120 && H < 180) {
-            r = 0, g = C, b = X;
-        }
-        else if (H >= 180 && H < 240) {
-            r = 0, g = X, b = C;
-        }
-        else if (H >= 240 && H < 300) {
-            r = X, g = 0, b = C;
-        }
-        else {
-            r = C, g = 0, b = X;
-        }
-        int R = (r + m) * 255;
-        int G = (g + m) * 255;
-        int B = (b + m) * 255;
-        
-        return { R, G, B, 255 };
-    }
-
 private:
-    std::vector<float> calculatePeakMaxArray()
-    {
-        auto freq_bin = m_config["data"]["freq_bin"];
-        std::vector<float> peakmaxArray;
-
-        // Calculate 2^14 FFT
-        const int size = 8192;
-        float buffer[size];
-        BASS_ChannelGetData(m_handle, &buffer, BASS_DATA_FFT16384);
-
-        // Get only the bins that have a frequency between the values in freq_bin
-        // using the formula: 
-        //           freq = bin_count * sampleRate / N
-        //
-        // Source: https://stackoverflow.com/questions/4364823/how-do-i-obtain-the-frequencies-of-each-value-in-an-fft/4371627#4371627
-        for (int i = 0; i < size; i++)
-        {
-            float freq = i * m_sampleRate / (size * 2);
-            for (int j = 0; j < freq_bin.size() - 1; j++)
-            {
-                if ((freq > freq_bin[j]) && (freq <= freq_bin[j + 1]))
-                    peakmaxArray.push_back(buffer[i]);
-            }
-        }
-        return peakmaxArray;
-    }
-
-    void visualiser2d(std::vector<float> peakmaxArray)
+    void visualiser2d(const std::vector<float>& peakmaxArray)
     {
         float barWidth  = m_config["visualiser2d"]["rectWidth"];
         float barAmp    = m_config["visualiser2d"]["barAmp"];
         float circleAmp = m_config["visualiser2d"]["circleAmp"];
         float aproxAmp  = m_config["visualiser2d"]["aproxAmp"];
 
-        // Spectrum colours
-        auto barColour      = m_config["visualiser2d"]["barColour"];
-        auto circleColour   = m_config["visualiser2d"]["circleColour"];
-
         // Draw bar spectrum
         float centerOffset = (float)(ScreenWidth() / 2) - (float)(peakmaxArray.size() * barWidth / 2);
-        for (int i = 0; i < peakmaxArray.size(); i++)
-        {
-            m_quad.setPosition(centerOffset + i * barWidth, ScreenHeight());
-            m_quad.setSize(barWidth, -peakmaxArray[i] * barAmp);
-            m_quad.setColour({ barColour[0], barColour[1], barColour[2], barColour[3] });
-            m_quad.setRotation(0);
-            m_quad.Draw();
-        }
+        m_spectrum.drawBars({ centerOffset, ScreenHeight() }, barWidth, barAmp, m_barPalette);
 
         // Draw circle spectrum
         float aprox = 0.0f;
@@ -288,82 +400,87 @@ private:
             aprox += peakmaxArray[i] * aproxAmp;
         aprox /= peakmaxArray.size();
 
-        // Get angle to rotate for circle points
-        const float angle = 360 / peakmaxArray.size();
-        for (int i = 0; i < peakmaxArray.size(); i++)
-        {
-            // Angle in circle
-            const float a = i * angle;
-
-            float cx = ScreenWidth()  / 2;
-            float cy = ScreenHeight() / 2;
-            float initRadius = m_config["visualiser2d"]["circleInitialRadius"];
-            float r = initRadius + aprox;
-
-            float x = cx + r * cosf(glm::radians(a));
-            float y = cy + r * sinf(glm::radians(a));
-
-            m_quad.setPosition(x, y);
-            m_quad.setSize(barWidth, -peakmaxArray[i] * circleAmp);
-            m_quad.setRotation(a + 90);
-            m_quad.setColour({ circleColour[0], circleColour[1], circleColour[2], circleColour[3] });
-            m_quad.Draw();
-        }
+        float cx = ScreenWidth()  / 2;
+        float cy = ScreenHeight() / 2;
+        float initRadius = m_config["visualiser2d"]["circleInitialRadius"];
+
+        // "sdf" draws the circle as one full-screen pass instead of one quad per bar
+        const auto& visualiser = m_config["visualiser2d"];
+        if (visualiser.value("circleStyle", "quads") == "sdf")
+            m_spectrum.drawRadial({ cx, cy }, initRadius + aprox, barWidth, circleAmp,
+                visualiser.value("circleRingWidth", 2.0f), visualiser.value("circleGlow", 0.0f), m_circlePalette);
+        else
+            m_spectrum.drawCircle({ cx, cy }, initRadius + aprox, barWidth, circleAmp, m_circlePalette);
     }
 
-    void visualiser3d(std::vector<float> peakmaxArray)
+    void visualiser3d(const std::vector<float>& peakmaxArray)
     {
-        const std::vector<float> cameraPos      = m_config["visualiser3d"]["cameraPos"];
-        const std::vector<float> cameraRot      = m_config["visualiser3d"]["cameraRot"];
         const float barAmp                      = m_config["visualiser3d"]["barAmp"];
-        const std::vector<int> barHSV           = m_config["visualiser3d"]["barHSV"];
         const float circleRadius                = m_config["visualiser3d"]["circleRadius"];
-        
-        m_camera.setPosition({ cameraPos[0], cameraPos[1], cameraPos[2] });
-        m_camera.setRotation({ cameraRot[0], cameraRot[1], cameraRot[2] });
 
         // Get angle to rotate for the circle arc
         const float startAngle  = m_config["visualiser3d"]["startAngle"];
-        const float endAngle    = m_config["visualiser3d"]["endAngle"];;
-        const float availableAngleSpace = endAngle - startAngle;
+        const float endAngle    = m_config["visualiser3d"]["endAngle"];
 
-        const float angle = availableAngleSpace / peakmaxArray.size();
-        for (int i = 0; i < peakmaxArray.size(); i++)
+        // "waterfall" shows the spectrum history as terrain, one row is added per frame
+        if (m_config["visualiser3d"].value("style", "ring") == "waterfall")
         {
-            // Angle in arc
-            const float a = i * angle + startAngle;
-
-            float cx = 0;
-            float cy = 0;
-            float r = circleRadius;
-
-            float x = cx + r * cosf(glm::radians(a));
-            float z = cy + r * sinf(glm::radians(a));
-
-            m_cube.setScale({ 1, peakmaxArray[i] * barAmp, 1 });
-            m_cube.setPosition({ x, 0, z });
-            m_cube.setColour(HSVtoRGB(i * ((360 - barHSV[0]) / peakmaxArray.size()) + barHSV[0], barHSV[1], barHSV[2]));
-            m_cube.Draw(&m_camera);
+            m_waterfall.update(peakmaxArray);
+            m_waterfall.Draw(m_ringPalette);
+            return;
         }
+
+        // Whole ring in one instanced draw
+        m_spectrum.drawRing(circleRadius, startAngle, endAngle, barAmp, m_ringPalette);
     }
 
 private:
-    HSTREAM m_handle;
+    std::unique_ptr<AudioBackend> m_audio;
+
     int     m_sampleRate;
     int     m_deviceID;
     float   m_volume;
 
     std::string     m_audioTitle;
+    std::vector<std::string> m_hud;
+    // Latency and cost lines below the HUD, refreshed on a timer
+    std::vector<std::string> m_measurements;
+    float           m_measureAge;
+    bool            m_bSilencePresented;
     nlohmann::json  m_config;
+    float           m_time;
+
+    // View, projection, viewport and time shared by all shaders
+    FrameUniforms m_frame;
 
-    // 2d
-    Quad   m_quad;
+    // Spectrum magnitudes live in a texture, bars are built and coloured on the GPU
+    SpectrumRenderer m_spectrum;
+    Palette m_barPalette;
+    Palette m_circlePalette;
+    Palette m_ringPalette;
+    Waterfall m_waterfall;
+
+    // Scrolling heat map behind the 2d and 3d visualisers
+    Spectrogram m_spectrogram;
+    Palette     m_spectrogramPalette;
+
+    Palette                         m_particlePalette;
+    std::unique_ptr<ParticleSystem> m_particles;
+
+    // Glow post-process, the HUD is drawn after it
+    std::unique_ptr<Bloom> m_bloom;
+
+    // Scene render target scaled to hold the frame rate, HUD stays at native resolution
+    std::unique_ptr<DynamicResolution> m_resolution;
 
     // 3d
     Camera m_camera;
-    Cube   m_cube;
+
+    Analyser m_analyser;
 
     std::list<std::string> m_songList;
+
+    std::unique_ptr<VideoEncoder> m_video;
 };
 
 int main(int argc, char* argv[])
@@ -378,15 +495,79 @@ int main(int argc, char* argv[])
         printf("Could not find config.json!\n");
     else reader >> config;
 
-    VisualiserGL app("Visualiser", config["display"]["width"], config["display"]["height"], config);
+    // --headless renders offscreen through EGL (no window or audio device needed),
+    // --frames stops after that many frames and --screenshot saves the last one,
+    // --capture records every frame as raw RGBA,
+    // --render-video in out.y4m [--fps 60] [--size 3840x2160] renders a song offline
+    std::string song, screenshot, capture, video;
+    bool headless = false;
+    int  frames   = 0;
+    int  fps      = 60;
+    int  width    = config["display"]["width"];
+    int  height   = config["display"]["height"];
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--headless")
+            headless = true;
+        else if (arg == "--frames" && i + 1 < argc)
+            frames = atoi(argv[++i]);
+        else if (arg == "--screenshot" && i + 1 < argc)
+            screenshot = argv[++i];
+        else if (arg == "--capture" && i + 1 < argc)
+            capture = argv[++i];
+        else if (arg == "--render-video" && i + 2 < argc)
+        {
+            song     = argv[++i];
+            video    = argv[++i];
+            headless = true;
+        }
+        else if (arg == "--fps" && i + 1 < argc)
+            fps = std::max(1, atoi(argv[++i]));
+        else if (arg == "--size" && i + 1 < argc)
+        {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0)
+            {
+                printf("--size needs WIDTHxHEIGHT (e.g. 3840x2160), got %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else
+            song = arg;
+    }
+
+    // Nobody is listening, only decode
+    if (headless)
+        config["bass"]["backend"] = "null";
 
-    // Visualise single song given as argument
-    if (argc >= 2)
-        app.singleMode(argv[1]);
+    // Offline renders decode exactly one frame of audio per video frame, as fast as possible
+    if (!video.empty())
+    {
+        config["bass"]["null"]["clock"] = "fast";
+        config["bass"]["null"]["fps"]   = fps;
+    }
+
+    VisualiserGL app("Visualiser", width, height, config, headless);
+    app.FrameLimit(frames);
+
+    if (!video.empty() && !app.renderVideo(video, fps))
+        return 1;
+
+    if (!capture.empty())
+        app.StartCapture(std::make_unique<FrameCapture>(FrameCapture::rawFile(capture)));
+
+    // Visualise single song given as argument (or a synthetic source e.g. synth:sweep)
+    if (!song.empty())
+        app.singleMode(song);
     // If no arguments are given open the user interface that allows the user to choose multiple songs
     else
         app.playlistMode();
 
     app.Run();
+    app.StopCapture();
+    app.finishVideo();
+
+    if (headless && !screenshot.empty())
+        app.SaveFrame(screenshot);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+#ifndef MESHES_H
+#define MESHES_H
+
+#include <vector>
+
+#include <glad/glad.h>
+
+// Instanced geometry of the spectrum bars (quads) and the 3D ring (cubes)
+namespace mesh
+{
+    // Unit quad from (0,0) to (1,1) as two triangles (x, y)
+    inline std::vector<GLfloat> quadVertices()
+    {
+        return {
+            0.0f, 1.0f,
+            1.0f, 0.0f,
+            0.0f, 0.0f,
+
+            0.0f, 1.0f,
+            1.0f, 1.0f,
+            1.0f, 0.0f,
+        };
+    }
+
+    // Unit cube from (0,0,0) to (1,1,1), four vertices per face (x, y, z)
+    inline std::vector<GLfloat> cubeVertices()
+    {
+        return {
+            // Back face
+            1,1,0,
+            1,0,0,
+            0,0,0,
+            0,1,0,
+
+            // Front face
+            0,1,1,
+            0,0,1,
+            1,0,1,
+            1,1,1,
+
+            // Right face
+            1,1,1,
+            1,0,1,
+            1,0,0,
+            1,1,0,
+
+            // Left Face
+            0,1,0,
+            0,0,0,
+            0,0,1,
+            0,1,1,
+
+            // Top face
+            0,1,1,
+            1,1,1,
+            1,1,0,
+            0,1,0,
+
+            // Bottom face
+            0,0,1,
+            0,0,0,
+            1,0,0,
+            1,0,1
+        };
+    }
+
+    inline std::vector<GLuint> cubeIndices()
+    {
+        return {
+             0,1,3,
+             3,1,2,
+             4,5,7,
+             7,5,6,
+             8,9,11,
+             11,9,10,
+             12,13,15,
+             15,13,14,
+             16,17,19,
+             19,17,18,
+             20,21,23,
+             23,21,22
+        };
+    }
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include "palette.h"
+
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+Palette::Palette(const nlohmann::json& config)
+    : m_lut(GL_RGBA32F, GL_RGBA, sizeof(glm::vec4))
+{
+    m_mapping = { config.value("offset", 0.0f), config.value("byIndex", 1.0f), config.value("byMagnitude", 0.0f) };
+
+    std::vector<glm::vec4> lut(LUT_SIZE);
+    std::vector<float> hsv = config.value("hsv", std::vector<float>());
+    if (config.contains("hsv") && hsv.size() < 3)
+        printf("Palette hsv needs 3 values, using the stops\n");
+
+    if (hsv.size() >= 3)
+    {
+        for (int i = 0; i < LUT_SIZE; i++)
+            lut[i] = HSVtoRGB(hsv[0] + (360.0f - hsv[0]) * i / LUT_SIZE, hsv[1], hsv[2]);
+    }
+    else
+    {
+        std::vector<std::vector<float>> stops = config.value("stops", std::vector<std::vector<float>>());
+
+        // RGB stops are opaque, anything shorter is left out
+        for (size_t i = 0; i < stops.size(); i++)
+        {
+            if (stops[i].size() == 3)
+                stops[i].push_back(255.0f);
+            else if (stops[i].size() < 3)
+            {
+                printf("Palette stop %d needs 3 or 4 values, ignored\n", (int)i);
+                stops.erase(stops.begin() + i--);
+            }
+        }
+        if (stops.empty())
+            stops = { { 255, 255, 255, 255 } };
+
+        for (int i = 0; i < LUT_SIZE; i++)
+        {
+            // Linear interpolation between the two closest stops
+            float t = (stops.size() - 1) * i / (float)(LUT_SIZE - 1);
+            size_t a = std::min((size_t)t, stops.size() - 1);
+            size_t b = std::min(a + 1, stops.size() - 1);
+            float  f = t - a;
+
+            for (int c = 0; c < 4; c++)
+                lut[i][c] = (stops[a][c] * (1.0f - f) + stops[b][c] * f) / 255.0f;
+        }
+    }
+
+    m_lut.setData(lut.data(), LUT_SIZE);
+    m_lut.setFilter(GL_LINEAR);
+}
+
+void Palette::bind(int unit)
+{
+    m_lut.bind(unit);
+}
+
+glm::vec3 Palette::getMapping() const
+{
+    return m_mapping;
+}
+
+// H in degrees, S and V in 0-100, returns colour in 0-1
+glm::vec4 Palette::HSVtoRGB(float H, float S, float V)
+{
+    float s = S / 100;
+    float v = V / 100;
+    float C = s * v;
+    float X = C * (1 - std::abs(std::fmod(H / 60.0f, 2.0f) - 1));
+    float m = v - C;
+
+    float r, g, b;
+    if      (H < 60)  { r = C, g = X, b = 0; }
+    else if (H < 120) { r = X, g = C, b = 0; }
+    else if (H < 180) { r = 0, g = C, b = X; }
+    else if (H < 240) { r = 0, g = X, b = C; }
+    else if (H < 300) { r = X, g = 0, b = C; }
+    else              { r = C, g = 0, b = X; }
+
+    return { r + m, g + m, b + m, 1.0f };
+}
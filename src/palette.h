@@ -0,0 +1,36 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include "gl/glObjects.h"
+#include "libs/json.hpp"
+
+/*
+    Colour lookup table sampled by the spectrum shaders, so colouring bars costs nothing on the CPU.
+
+    Config (per visualiser preset):
+        "stops":       [[r, g, b, a], ...]   evenly spaced gradient (0-255), or
+        "hsv":         [h, s, v]             hue sweep from h to 360 (s and v in 0-100)
+        "offset":      0.0                   LUT position = offset
+        "byIndex":     1.0                              + byIndex     * bar index / bar count
+        "byMagnitude": 0.0                              + byMagnitude * bar magnitude
+*/
+class Palette
+{
+public:
+    static const int LUT_SIZE = 256;
+
+    Palette(const nlohmann::json& config);
+
+    void bind(int unit);
+
+    // (offset, byIndex, byMagnitude) for the paletteMapping uniform
+    glm::vec3 getMapping() const;
+
+private:
+    gl::DataTexture1D m_lut;
+    glm::vec3         m_mapping;
+
+    static glm::vec4 HSVtoRGB(float H, float S, float V);
+};
+
+#endif
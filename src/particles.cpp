@@ -0,0 +1,157 @@
+#include "particles.h"
+
+#ifdef _WIN32
+#include <SDL.h>
+#elif __linux__
+#include <SDL2/SDL.h>
+#endif
+#include <algorithm>
+#include <cstddef>
+#include <random>
+
+#include "frameUniforms.h"
+#include "palette.h"
+
+ParticleSystem::ParticleSystem(const nlohmann::json& config)
+    : m_count(std::max(1, config.value("count", 1000000)))
+    , m_lifetime(config.value("lifetime", 3.0f))
+    , m_speed(config.value("speed", 300.0f))
+    , m_size(config.value("size", 2.0f))
+    , m_dustRate(config.value("dustRate", 0.05f))
+    , m_burst(config.value("burst", 0.02f))
+    , m_swirl(config.value("swirl", 2.0f))
+    , m_beatThreshold(config.value("beatThreshold", 1.5f))
+    , m_bassBands(config.value("bassBands", 0.125f))
+    , m_bassAverage(0.0f)
+    , m_beatCooldown(0.0f)
+    , m_bBeat(false)
+    , m_frame(0)
+    , m_current(0)
+{
+    // Get basepath for the assets folder
+    char* basePath = SDL_GetBasePath();
+    std::string shaderPath = basePath + std::string("assets/shaders/");
+    SDL_free(basePath);
+
+    // Simulation, the outputs are captured into the other buffer
+    m_updateShader.setAttribute(0, "position");
+    m_updateShader.setAttribute(1, "velocity");
+    m_updateShader.setAttribute(2, "life");
+    m_updateShader.setAttribute(3, "seed");
+    m_updateShader.setFeedbackVaryings({ "outPosition", "outVelocity", "outLife", "outSeed" });
+    m_updateShader.createProgram(shaderPath + "particlesUpdate");
+
+    static const char* const updateUniforms[U_UPDATE_COUNT] = { "dt", "frame", "spawn", "energy", "emitter", "speed", "lifetime", "swirl" };
+    m_updateShader.resolveUniforms(updateUniforms);
+
+    // Rendering
+    m_drawShader.setAttribute(0, "position");
+    m_drawShader.setAttribute(2, "life");
+    m_drawShader.setAttribute(3, "seed");
+    m_drawShader.createProgram(shaderPath + "particles");
+
+    static const char* const drawUniforms[D_DRAW_COUNT] = { "palette", "paletteMapping", "lifetime", "size" };
+    m_drawShader.resolveUniforms(drawUniforms);
+    m_drawShader.bindUniformBlock("Frame", FrameUniforms::BINDING);
+    m_drawShader.Bind();
+    glUniform1i(m_drawShader.uniform(D_PALETTE), 1);
+    m_drawShader.Unbind();
+
+    // Everything starts dead, the seed gives every particle its own random stream
+    std::vector<Particle> particles(m_count);
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (auto& particle : particles)
+        particle = { glm::vec2(0.0f), glm::vec2(0.0f), 0.0f, unit(random) };
+
+    for (int i = 0; i < 2; i++)
+    {
+        m_VAOs[i].Bind();
+        m_VBOs[i].setData(particles.data(), sizeof(Particle) * m_count, GL_STREAM_COPY);
+        setAttributes(i);
+        m_VAOs[i].Unbind();
+    }
+
+    gl::StateCache::get().setEnabled(GL_PROGRAM_POINT_SIZE, true);
+    printf("Particles: %d on the GPU (%.1f MB)\n", m_count, 2.0f * sizeof(Particle) * m_count / (1024.0f * 1024.0f));
+}
+
+void ParticleSystem::setAttributes(int buffer)
+{
+    const int stride = sizeof(Particle);
+    m_VBOs[buffer].setAttribute(0, 2, stride, offsetof(Particle, position));
+    m_VBOs[buffer].setAttribute(1, 2, stride, offsetof(Particle, velocity));
+    m_VBOs[buffer].setAttribute(2, 1, stride, offsetof(Particle, life));
+    m_VBOs[buffer].setAttribute(3, 1, stride, offsetof(Particle, seed));
+}
+
+void ParticleSystem::update(const std::vector<float>& magnitudes, float elapsed, glm::vec2 emitter)
+{
+    // Bass energy against its running average (about one second)
+    int bass = std::max(1, (int)(magnitudes.size() * m_bassBands));
+    float energy = 0.0f;
+    for (int i = 0; i < bass && i < (int)magnitudes.size(); i++)
+        energy += magnitudes[i];
+    energy /= bass;
+
+    m_bassAverage += (energy - m_bassAverage) * std::min(1.0f, elapsed);
+    m_beatCooldown = std::max(0.0f, m_beatCooldown - elapsed);
+
+    m_bBeat = m_beatCooldown == 0.0f && energy > 0.0f && energy > m_bassAverage * m_beatThreshold;
+    if (m_bBeat)
+        m_beatCooldown = 0.15f;
+
+    float spawn  = std::min(1.0f, m_dustRate * elapsed + (m_bBeat ? m_burst : 0.0f));
+    float relative = m_bassAverage > 0.0f ? std::min(2.0f, energy / m_bassAverage) : 0.0f;
+
+    m_updateShader.Bind();
+    m_updateShader.loadFloat(m_updateShader.uniform(U_DT), elapsed);
+    glUniform1ui(m_updateShader.uniform(U_FRAME), m_frame++);
+    m_updateShader.loadFloat(m_updateShader.uniform(U_SPAWN), spawn);
+    m_updateShader.loadFloat(m_updateShader.uniform(U_ENERGY), relative);
+    m_updateShader.loadVector2(m_updateShader.uniform(U_EMITTER), emitter);
+    m_updateShader.loadFloat(m_updateShader.uniform(U_SPEED), m_speed);
+    m_updateShader.loadFloat(m_updateShader.uniform(U_LIFETIME), m_lifetime);
+    m_updateShader.loadFloat(m_updateShader.uniform(U_SWIRL), m_swirl);
+
+    // Read the current state, capture the next one into the other buffer
+    int next = 1 - m_current;
+    gl::StateCache& state = gl::StateCache::get();
+    state.bindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, m_VBOs[next].VBO);
+    state.setEnabled(GL_RASTERIZER_DISCARD, true);
+
+    m_VAOs[m_current].Bind();
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, m_count);
+    glEndTransformFeedback();
+    m_VAOs[m_current].Unbind();
+
+    state.setEnabled(GL_RASTERIZER_DISCARD, false);
+    state.bindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    m_updateShader.Unbind();
+
+    m_current = next;
+}
+
+void ParticleSystem::Draw(Palette& palette)
+{
+    m_drawShader.Bind();
+    m_drawShader.loadVector3(m_drawShader.uniform(D_PALETTE_MAPPING), palette.getMapping());
+    m_drawShader.loadFloat(m_drawShader.uniform(D_LIFETIME), m_lifetime);
+    m_drawShader.loadFloat(m_drawShader.uniform(D_SIZE), m_size);
+    palette.bind(1);
+
+    gl::StateCache& state = gl::StateCache::get();
+    state.setEnabled(GL_DEPTH_TEST, false);
+    state.setEnabled(GL_BLEND, true);
+    state.blendFunc(GL_SRC_ALPHA, GL_ONE);
+
+    m_VAOs[m_current].Bind();
+    glDrawArrays(GL_POINTS, 0, m_count);
+    m_VAOs[m_current].Unbind();
+
+    state.setEnabled(GL_BLEND, false);
+    state.setEnabled(GL_DEPTH_TEST, true);
+
+    m_drawShader.Unbind();
+}
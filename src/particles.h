@@ -0,0 +1,85 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <vector>
+
+#include "gl/glObjects.h"
+#include "libs/json.hpp"
+
+class Palette;
+
+/*
+    Particle layer simulated entirely on the GPU. The particle state lives in two VBOs,
+    each frame a transform feedback pass reads one and writes the other (rasterizer
+    off), then the result is drawn as points. The CPU only turns the analysis frame
+    into a few uniforms: a spawn fraction (continuous dust plus bursts on detected
+    beats) and the bass energy that drives the swirl, nothing is done per particle.
+
+    Config (particles):
+        "active":        false
+        "count":         1000000    particles allocated on the GPU
+        "lifetime":      3.0        seconds
+        "speed":         300        launch speed in pixels per second
+        "size":          2.0        point size in pixels
+        "dustRate":      0.05       fraction of dead particles respawned per second
+        "burst":         0.02       fraction of dead particles respawned on a beat
+        "swirl":         2.0        tangential acceleration per unit of bass energy
+        "beatThreshold": 1.5        bass energy over its running average that counts as a beat
+        "bassBands":     0.125      low part of the bands used for the bass energy
+        "palette":       { ... }    see Palette, byIndex is a per particle random, byMagnitude the remaining life
+*/
+class ParticleSystem
+{
+public:
+    ParticleSystem(const nlohmann::json& config);
+
+    // Beat detection on the analysis frame and one simulation step on the GPU
+    void update(const std::vector<float>& magnitudes, float elapsed, glm::vec2 emitter);
+
+    // Additive points over what is already drawn
+    void Draw(Palette& palette);
+
+    bool onBeat() const { return m_bBeat; }
+
+private:
+    // Must match the feedback varyings of particlesUpdate.vert
+    struct Particle
+    {
+        glm::vec2 position;
+        glm::vec2 velocity;
+        float     life;
+        float     seed;
+    };
+
+    int   m_count;
+    float m_lifetime;
+    float m_speed;
+    float m_size;
+    float m_dustRate;
+    float m_burst;
+    float m_swirl;
+    float m_beatThreshold;
+    float m_bassBands;
+
+    // Beat detection
+    float m_bassAverage;
+    float m_beatCooldown;
+    bool  m_bBeat;
+
+    GLuint m_frame;
+    int    m_current;   // buffer holding the latest state
+
+    gl::VertexArray        m_VAOs[2];
+    gl::VertexBufferObject m_VBOs[2];
+
+    gl::Shader m_updateShader;
+    gl::Shader m_drawShader;
+
+    // Uniform handles of m_updateShader and m_drawShader
+    enum UpdateUniform { U_DT, U_FRAME, U_SPAWN, U_ENERGY, U_EMITTER, U_SPEED, U_LIFETIME, U_SWIRL, U_UPDATE_COUNT };
+    enum DrawUniform { D_PALETTE, D_PALETTE_MAPPING, D_LIFETIME, D_SIZE, D_DRAW_COUNT };
+
+    void setAttributes(int buffer);
+};
+
+#endif
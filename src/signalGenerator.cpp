@@ -0,0 +1,145 @@
+#include "signalGenerator.h"
+
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+static const double TWO_PI = 6.283185307179586;
+// Lowest sweep frequency in Hz
+static const double MIN_SWEEP_FREQUENCY = 1.0;
+// Fewest impulses per second, one every 100 seconds
+static const double MIN_IMPULSE_RATE = 0.01;
+
+const std::string SignalGenerator::PREFIX = "synth:";
+
+bool SignalGenerator::parse(const std::string& path, Type& type)
+{
+    if (path.compare(0, PREFIX.size(), PREFIX) != 0)
+        return false;
+
+    std::string name = path.substr(PREFIX.size());
+    if      (name == "sweep")   type = Type::Sweep;
+    else if (name == "tones")   type = Type::Tones;
+    else if (name == "white")   type = Type::WhiteNoise;
+    else if (name == "pink")    type = Type::PinkNoise;
+    else if (name == "impulse") type = Type::Impulse;
+    else
+    {
+        printf("Unknown synthetic source: %s\n", name.c_str());
+        return false;
+    }
+    return true;
+}
+
+SignalGenerator::SignalGenerator(Type type, int sampleRate, const nlohmann::json& config)
+    : m_type(type)
+    , m_sampleRate(sampleRate)
+    , m_frame(0)
+    , m_pink{ 0, 0, 0, 0, 0, 0, 0 }
+{
+    m_amplitude   = config.value("amplitude", 0.5f);
+    m_totalFrames = (int64_t)(config.value("duration", 30.0) * m_sampleRate);
+    m_seed        = config.value("seed", 1u);
+    if (m_seed == 0)
+        m_seed = 1;
+
+    std::vector<double> sweep = config.value("sweep", std::vector<double>{ 20.0, 20000.0 });
+    if (sweep.size() < 2)
+    {
+        printf("synth.sweep needs a start and an end frequency, using 20 - 20000 Hz\n");
+        sweep = { 20.0, 20000.0 };
+    }
+    // The sweep is logarithmic, so both ends have to be positive. Keep it below
+    // nyquist for low sample rates
+    m_sweepStart = std::max(sweep[0], MIN_SWEEP_FREQUENCY);
+    m_sweepEnd   = std::max(std::min(sweep[1], m_sampleRate / 2.0), MIN_SWEEP_FREQUENCY);
+
+    m_tones = config.value("tones", std::vector<double>{ 110.0, 440.0, 1000.0, 5000.0 });
+    m_phases.assign(m_tones.size(), 0.0);
+
+    // Clamped before dividing, a zero or negative rate has no period
+    double impulseRate = std::max(config.value("impulseRate", 2.0), MIN_IMPULSE_RATE);
+    m_impulsePeriod = std::max<int64_t>(1, (int64_t)(m_sampleRate / impulseRate));
+}
+
+int SignalGenerator::render(float* out, int frames)
+{
+    int count = (int)std::min<int64_t>(frames, m_totalFrames - m_frame);
+    for (int i = 0; i < count; i++)
+    {
+        float s = sample() * m_amplitude;
+        out[i * 2]     = s;
+        out[i * 2 + 1] = s;
+        m_frame++;
+    }
+    return count;
+}
+
+int SignalGenerator::getSampleRate() const
+{
+    return m_sampleRate;
+}
+
+bool SignalGenerator::finished() const
+{
+    return m_frame >= m_totalFrames;
+}
+
+// xorshift32 mapped to [-1, 1]
+float SignalGenerator::nextWhite()
+{
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    return (m_seed / 4294967295.0f) * 2.0f - 1.0f;
+}
+
+// Paul Kellet's refined pink noise filter (-3dB/octave)
+float SignalGenerator::nextPink()
+{
+    float white = nextWhite();
+    m_pink[0] = 0.99886f * m_pink[0] + white * 0.0555179f;
+    m_pink[1] = 0.99332f * m_pink[1] + white * 0.0750759f;
+    m_pink[2] = 0.96900f * m_pink[2] + white * 0.1538520f;
+    m_pink[3] = 0.86650f * m_pink[3] + white * 0.3104856f;
+    m_pink[4] = 0.55000f * m_pink[4] + white * 0.5329522f;
+    m_pink[5] = -0.7616f * m_pink[5] - white * 0.0168980f;
+    float pink = m_pink[0] + m_pink[1] + m_pink[2] + m_pink[3] + m_pink[4] + m_pink[5] + m_pink[6] + white * 0.5362f;
+    m_pink[6] = white * 0.115926f;
+    return pink * 0.11f;
+}
+
+float SignalGenerator::sample()
+{
+    switch (m_type)
+    {
+    case Type::Sweep:
+    {
+        // Exponential (log) sine sweep over the whole duration
+        //      phase(t) = 2pi * f1 * T / ln(f2/f1) * (e^(t/T * ln(f2/f1)) - 1)
+        double T = (double)m_totalFrames / m_sampleRate;
+        double t = (double)m_frame / m_sampleRate;
+        double k = std::log(m_sweepEnd / m_sweepStart);
+        if (std::fabs(k) < 1e-9)
+            return (float)std::sin(TWO_PI * m_sweepStart * t);
+        return (float)std::sin(TWO_PI * m_sweepStart * T / k * (std::exp(t / T * k) - 1.0));
+    }
+    case Type::Tones:
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < m_tones.size(); i++)
+        {
+            sum += std::sin(m_phases[i]);
+            m_phases[i] = std::fmod(m_phases[i] + TWO_PI * m_tones[i] / m_sampleRate, TWO_PI);
+        }
+        return m_tones.empty() ? 0.0f : (float)(sum / m_tones.size());
+    }
+    case Type::WhiteNoise:
+        return nextWhite();
+    case Type::PinkNoise:
+        return nextPink();
+    case Type::Impulse:
+        return (m_frame % m_impulsePeriod) == 0 ? 1.0f : 0.0f;
+    }
+    return 0.0f;
+}
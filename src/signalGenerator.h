@@ -0,0 +1,65 @@
+#ifndef SIGNALGENERATOR_H
+#define SIGNALGENERATOR_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "libs/json.hpp"
+
+// Built-in test signal source, used instead of an audio file by passing "synth:<type>"
+// as the song path (e.g. synth:sweep, synth:tones, synth:white, synth:pink, synth:impulse)
+class SignalGenerator
+{
+public:
+    enum class Type
+    {
+        Sweep,
+        Tones,
+        WhiteNoise,
+        PinkNoise,
+        Impulse
+    };
+
+    static const std::string PREFIX;
+
+    // Returns true if the path names a synthetic source and sets type accordingly
+    static bool parse(const std::string& path, Type& type);
+
+    SignalGenerator(Type type, int sampleRate, const nlohmann::json& config);
+
+    // Writes interleaved stereo float frames, returns the number of frames written
+    // which is less than requested once the configured duration is reached
+    int render(float* out, int frames);
+
+    int  getSampleRate() const;
+    bool finished() const;
+
+private:
+    Type  m_type;
+    int   m_sampleRate;
+    float m_amplitude;
+
+    int64_t m_frame;
+    int64_t m_totalFrames;
+
+    // Log sweep
+    double m_sweepStart, m_sweepEnd;
+
+    // Multi-tone chord
+    std::vector<double> m_tones;
+    std::vector<double> m_phases;
+
+    // Noise
+    uint32_t m_seed;
+    float    m_pink[7];
+
+    // Impulse train
+    int64_t m_impulsePeriod;
+
+    float nextWhite();
+    float nextPink();
+    float sample();
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "spectrogram.h"
+
+#ifdef _WIN32
+#include <SDL.h>
+#elif __linux__
+#include <SDL2/SDL.h>
+#endif
+#include <algorithm>
+
+#include "frameUniforms.h"
+#include "palette.h"
+
+Spectrogram::Spectrogram(const nlohmann::json& config)
+    : m_history(std::max(2, config.value("columns", 1024)))
+    , m_range(config.value("range", 60.0f))
+{
+    // Get basepath for the assets folder
+    char* basePath = SDL_GetBasePath();
+    std::string shaderPath = basePath + std::string("assets/shaders/");
+    SDL_free(basePath);
+
+    m_shader.createProgram(shaderPath + "spectrogram");
+
+    static const char* const uniforms[U_COUNT] = { "history", "palette", "paletteMapping", "head", "rectPosition", "rectSize", "range" };
+    m_shader.resolveUniforms(uniforms);
+
+    m_shader.bindUniformBlock("Frame", FrameUniforms::BINDING);
+    m_shader.Bind();
+    glUniform1i(m_shader.uniform(U_HISTORY), 0);
+    glUniform1i(m_shader.uniform(U_PALETTE), 1);
+    m_shader.Unbind();
+}
+
+void Spectrogram::push(const std::vector<float>& magnitudes)
+{
+    // A new band count starts a new history
+    m_history.pushLine(magnitudes.data(), (int)magnitudes.size());
+}
+
+void Spectrogram::Draw(glm::vec2 position, glm::vec2 size, Palette& palette)
+{
+    if (m_history.width == 0)
+        return;
+
+    m_shader.Bind();
+    glUniform1i(m_shader.uniform(U_HEAD), m_history.head);
+    m_shader.loadVector3(m_shader.uniform(U_PALETTE_MAPPING), palette.getMapping());
+    m_shader.loadVector2(m_shader.uniform(U_RECT_POSITION), position);
+    m_shader.loadVector2(m_shader.uniform(U_RECT_SIZE), size);
+    m_shader.loadFloat(m_shader.uniform(U_RANGE), m_range);
+
+    m_history.bind(0);
+    palette.bind(1);
+
+    // Background layer, everything else is drawn over it
+    gl::StateCache& state = gl::StateCache::get();
+    state.depthMask(false);
+
+    m_VAO.Bind();
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    m_VAO.Unbind();
+
+    state.depthMask(true);
+
+    m_shader.Unbind();
+}
@@ -0,0 +1,46 @@
+#ifndef SPECTROGRAM_H
+#define SPECTROGRAM_H
+
+#include <vector>
+
+#include "gl/glObjects.h"
+#include "libs/json.hpp"
+
+class Palette;
+
+/*
+    Scrolling time x frequency heat map. Every analysis frame is one line of a ring
+    buffered texture, the fragment shader maps screen x to the age of a line (newest on
+    the right) by offsetting from the ring head, so scrolling never re-uploads history.
+    Each push is a single glTexSubImage2D of one line.
+
+    Config (spectrogram):
+        "active":  false
+        "columns": 1024     history length in analysis frames
+        "range":   60       dB below full scale mapped to the bottom of the palette
+        "palette": { ... }  see Palette, byIndex is the position in the spectrum
+*/
+class Spectrogram
+{
+public:
+    Spectrogram(const nlohmann::json& config);
+
+    // Uploads this analysis frame's magnitudes as the newest column
+    void push(const std::vector<float>& magnitudes);
+
+    // Fills the screen rectangle (pixels, top left origin)
+    void Draw(glm::vec2 position, glm::vec2 size, Palette& palette);
+
+private:
+    gl::RingTexture2D m_history;
+
+    float m_range;
+
+    gl::VertexArray m_VAO;
+    gl::Shader      m_shader;
+
+    // Uniform handles of m_shader
+    enum Uniform { U_HISTORY, U_PALETTE, U_PALETTE_MAPPING, U_HEAD, U_RECT_POSITION, U_RECT_SIZE, U_RANGE, U_COUNT };
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include "spectrumRenderer.h"
+
+#ifdef _WIN32
+#include <SDL.h>
+#elif __linux__
+#include <SDL2/SDL.h>
+#endif
+
+#include "frameUniforms.h"
+#include "meshes.h"
+#include "palette.h"
+
+SpectrumRenderer::SpectrumRenderer()
+    : m_count(0)
+{
+    // Get basepath for the assets folder
+    char* basePath = SDL_GetBasePath();
+    std::string shaderPath = basePath + std::string("assets/shaders/");
+    SDL_free(basePath);
+
+    // 2d
+    m_quadShader.setAttribute(0, "position");
+    m_quadShader.createProgram(shaderPath + "spectrumQuad");
+
+    static const char* const quadUniforms[Q_COUNT] = {
+        "spectrum", "palette", "paletteMapping", "origin", "barWidth", "amplitude", "circular", "radius", "angleStep"
+    };
+    m_quadShader.resolveUniforms(quadUniforms);
+
+    m_quadShader.bindUniformBlock("Frame", FrameUniforms::BINDING);
+    m_quadShader.Bind();
+    glUniform1i(m_quadShader.uniform(Q_SPECTRUM), 0);
+    glUniform1i(m_quadShader.uniform(Q_PALETTE), 1);
+    m_quadShader.Unbind();
+
+    m_quadVAO.Bind();
+    m_quadVBO.setData(mesh::quadVertices(), 0, 2);
+    m_quadVAO.Unbind();
+
+    // 2d radial
+    m_radialShader.createProgram(shaderPath + "fullscreen.vert", shaderPath + "spectrumRadial.frag");
+
+    static const char* const radialUniforms[R_COUNT] = {
+        "spectrum", "palette", "paletteMapping", "centre", "radius", "barWidth", "amplitude", "ringWidth", "glow"
+    };
+    m_radialShader.resolveUniforms(radialUniforms);
+
+    m_radialShader.bindUniformBlock("Frame", FrameUniforms::BINDING);
+    m_radialShader.Bind();
+    glUniform1i(m_radialShader.uniform(R_SPECTRUM), 0);
+    glUniform1i(m_radialShader.uniform(R_PALETTE), 1);
+    m_radialShader.Unbind();
+
+    // 3d
+    m_cubeShader.setAttribute(0, "position");
+    m_cubeShader.createProgram(shaderPath + "spectrumCube");
+
+    static const char* const cubeUniforms[C_COUNT] = {
+        "spectrum", "palette", "paletteMapping", "radius", "startAngle", "angleStep", "amplitude"
+    };
+    m_cubeShader.resolveUniforms(cubeUniforms);
+
+    m_cubeShader.bindUniformBlock("Frame", FrameUniforms::BINDING);
+    m_cubeShader.Bind();
+    glUniform1i(m_cubeShader.uniform(C_SPECTRUM), 0);
+    glUniform1i(m_cubeShader.uniform(C_PALETTE), 1);
+    m_cubeShader.Unbind();
+
+    m_cubeVAO.Bind();
+    m_cubeVBO.setData(mesh::cubeVertices(), 0, 3);
+    m_cubeEBO.setData(mesh::cubeIndices());
+    m_cubeVAO.Unbind();
+}
+
+void SpectrumRenderer::update(const std::vector<float>& magnitudes)
+{
+    m_count = (int)magnitudes.size();
+    m_spectrum.setData(magnitudes.data(), m_count);
+}
+
+void SpectrumRenderer::drawBars(glm::vec2 origin, float barWidth, float amplitude, Palette& palette)
+{
+    drawQuads(origin, barWidth, amplitude, palette, false, 0.0f);
+}
+
+void SpectrumRenderer::drawCircle(glm::vec2 centre, float radius, float barWidth, float amplitude, Palette& palette)
+{
+    drawQuads(centre, barWidth, amplitude, palette, true, radius);
+}
+
+void SpectrumRenderer::drawRadial(glm::vec2 centre, float radius, float barWidth, float amplitude, float ringWidth, float glow, Palette& palette)
+{
+    if (m_count == 0)
+        return;
+
+    m_radialShader.Bind();
+    m_radialShader.loadVector3(m_radialShader.uniform(R_PALETTE_MAPPING), palette.getMapping());
+    m_radialShader.loadVector2(m_radialShader.uniform(R_CENTRE), centre);
+    m_radialShader.loadFloat(m_radialShader.uniform(R_RADIUS), radius);
+    m_radialShader.loadFloat(m_radialShader.uniform(R_BAR_WIDTH), barWidth);
+    m_radialShader.loadFloat(m_radialShader.uniform(R_AMPLITUDE), amplitude);
+    m_radialShader.loadFloat(m_radialShader.uniform(R_RING_WIDTH), ringWidth);
+    m_radialShader.loadFloat(m_radialShader.uniform(R_GLOW), glow);
+
+    m_spectrum.bind(0);
+    palette.bind(1);
+
+    // Anti-aliased edges and glow are blended over whatever is already drawn
+    gl::StateCache& state = gl::StateCache::get();
+    state.setEnabled(GL_DEPTH_TEST, false);
+    state.setEnabled(GL_BLEND, true);
+    state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    m_radialVAO.Bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    m_radialVAO.Unbind();
+
+    state.setEnabled(GL_BLEND, false);
+    state.setEnabled(GL_DEPTH_TEST, true);
+
+    m_radialShader.Unbind();
+}
+
+void SpectrumRenderer::drawRing(float radius, float startAngle, float endAngle, float amplitude, Palette& palette)
+{
+    if (m_count == 0)
+        return;
+
+    m_cubeShader.Bind();
+    m_cubeShader.loadFloat(m_cubeShader.uniform(C_RADIUS), radius);
+    m_cubeShader.loadFloat(m_cubeShader.uniform(C_START_ANGLE), startAngle);
+    m_cubeShader.loadFloat(m_cubeShader.uniform(C_ANGLE_STEP), (endAngle - startAngle) / m_count);
+    m_cubeShader.loadFloat(m_cubeShader.uniform(C_AMPLITUDE), amplitude);
+    m_cubeShader.loadVector3(m_cubeShader.uniform(C_PALETTE_MAPPING), palette.getMapping());
+
+    m_spectrum.bind(0);
+    palette.bind(1);
+
+    m_cubeVAO.Bind();
+    glDrawElementsInstanced(GL_TRIANGLES, m_cubeEBO.size, GL_UNSIGNED_INT, 0, m_count);
+    m_cubeVAO.Unbind();
+
+    m_cubeShader.Unbind();
+}
+
+void SpectrumRenderer::drawQuads(glm::vec2 origin, float barWidth, float amplitude, Palette& palette, bool circular, float radius)
+{
+    if (m_count == 0)
+        return;
+
+    m_quadShader.Bind();
+    m_quadShader.loadVector3(m_quadShader.uniform(Q_PALETTE_MAPPING), palette.getMapping());
+    m_quadShader.loadVector2(m_quadShader.uniform(Q_ORIGIN), origin);
+    m_quadShader.loadFloat(m_quadShader.uniform(Q_BAR_WIDTH), barWidth);
+    m_quadShader.loadFloat(m_quadShader.uniform(Q_AMPLITUDE), amplitude);
+    m_quadShader.loadBool(m_quadShader.uniform(Q_CIRCULAR), circular);
+    m_quadShader.loadFloat(m_quadShader.uniform(Q_RADIUS), radius);
+    m_quadShader.loadFloat(m_quadShader.uniform(Q_ANGLE_STEP), 360.0f / m_count);
+
+    m_spectrum.bind(0);
+    palette.bind(1);
+
+    m_quadVAO.Bind();
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, m_count);
+    m_quadVAO.Unbind();
+
+    m_quadShader.Unbind();
+}
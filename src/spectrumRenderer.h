@@ -0,0 +1,66 @@
+#ifndef SPECTRUMRENDERER_H
+#define SPECTRUMRENDERER_H
+
+#include <vector>
+
+#include "gl/glObjects.h"
+
+class Palette;
+
+// Draws spectra from a texture of band magnitudes. The CPU only uploads the
+// magnitudes once per frame, every bar's position, rotation and height is derived
+// in the vertex shader from gl_InstanceID, so the cost doesn't grow with bar count.
+class SpectrumRenderer
+{
+public:
+    SpectrumRenderer();
+
+    // Uploads this frame's magnitudes (one texel per bar)
+    void update(const std::vector<float>& magnitudes);
+
+    // Bar colours come from the palette, indexed by bar index and magnitude on the GPU
+
+    // Row of bars growing up from origin (bottom left of the first bar)
+    void drawBars(glm::vec2 origin, float barWidth, float amplitude, Palette& palette);
+    // Bars pointing outwards from a circle of the given radius
+    void drawCircle(glm::vec2 centre, float radius, float barWidth, float amplitude, Palette& palette);
+    // Same circle as one full-screen pass: the fragment shader evaluates anti-aliased
+    // distance fields of the bars, a ring of ringWidth and a glow falloff (pixels) in
+    // polar coordinates, the cost only depends on the resolution, not the bar count
+    void drawRadial(glm::vec2 centre, float radius, float barWidth, float amplitude, float ringWidth, float glow, Palette& palette);
+    // 3D cubes on an arc of the given radius from startAngle to endAngle (degrees)
+    void drawRing(float radius, float startAngle, float endAngle, float amplitude, Palette& palette);
+
+private:
+    int m_count;
+
+    gl::DataTexture1D m_spectrum;
+
+    // 2d
+    gl::VertexArray        m_quadVAO;
+    gl::VertexBufferObject m_quadVBO;
+    gl::Shader             m_quadShader;
+
+    // Uniform handles of m_quadShader
+    enum QuadUniform { Q_SPECTRUM, Q_PALETTE, Q_PALETTE_MAPPING, Q_ORIGIN, Q_BAR_WIDTH, Q_AMPLITUDE, Q_CIRCULAR, Q_RADIUS, Q_ANGLE_STEP, Q_COUNT };
+
+    // 2d radial (no vertex data, the triangle comes from gl_VertexID)
+    gl::VertexArray        m_radialVAO;
+    gl::Shader             m_radialShader;
+
+    // Uniform handles of m_radialShader
+    enum RadialUniform { R_SPECTRUM, R_PALETTE, R_PALETTE_MAPPING, R_CENTRE, R_RADIUS, R_BAR_WIDTH, R_AMPLITUDE, R_RING_WIDTH, R_GLOW, R_COUNT };
+
+    // 3d
+    gl::VertexArray        m_cubeVAO;
+    gl::VertexBufferObject m_cubeVBO;
+    gl::ElementArrayBuffer m_cubeEBO;
+    gl::Shader             m_cubeShader;
+
+    // Uniform handles of m_cubeShader
+    enum CubeUniform { C_SPECTRUM, C_PALETTE, C_PALETTE_MAPPING, C_RADIUS, C_START_ANGLE, C_ANGLE_STEP, C_AMPLITUDE, C_COUNT };
+
+    void drawQuads(glm::vec2 origin, float barWidth, float amplitude, Palette& palette, bool circular, float radius);
+};
+
+#endif
@@ -0,0 +1,93 @@
+#include "videoEncoder.h"
+
+#ifdef _WIN32
+#include <SDL.h>
+#elif __linux__
+#include <SDL2/SDL.h>
+#endif
+#include <cstdio>
+#include <memory>
+
+// Writer thread side: the header once, then every frame behind a FRAME marker
+static FrameCapture::Writer y4mWriter(const std::string& path, int width, int height, int fps)
+{
+    std::shared_ptr<FILE> file(fopen(path.c_str(), "wb"), [](FILE* f) { if (f) fclose(f); });
+    if (!file)
+    {
+        printf("Could not open %s for writing\n", path.c_str());
+        return [](const unsigned char*, int, int) {};
+    }
+
+    fprintf(file.get(), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XYSCSS=420JPEG XCOLORRANGE=LIMITED\n", width, height, fps);
+
+    return [file](const unsigned char* pixels, int texels, int rows)
+    {
+        fputs("FRAME\n", file.get());
+        fwrite(pixels, 1, (size_t)texels * rows * 4, file.get());
+    };
+}
+
+VideoEncoder::VideoEncoder(const std::string& path, int width, int height, int fps)
+    : m_width(width)
+    , m_height(height)
+    , m_yuv(width / 4, height * 3 / 2, GL_RGBA8, false)
+    , m_capture(y4mWriter(path, width, height, fps), 4)
+{
+    // Get basepath for the assets folder
+    char* basePath = SDL_GetBasePath();
+    std::string shaderPath = basePath + std::string("assets/shaders/");
+    SDL_free(basePath);
+
+    m_shader.createProgram(shaderPath + "fullscreen.vert", shaderPath + "rgbToYuv.frag");
+
+    static const char* const uniforms[U_COUNT] = { "source", "size" };
+    m_shader.resolveUniforms(uniforms);
+
+    m_shader.Bind();
+    glUniform1i(m_shader.uniform(U_SOURCE), 0);
+    glUniform2i(m_shader.uniform(U_SIZE), width, height);
+    m_shader.Unbind();
+}
+
+VideoEncoder::~VideoEncoder()
+{
+    finish();
+}
+
+void VideoEncoder::encode(GLuint texture)
+{
+    // Remember where the frame was drawn, the conversion has its own target
+    GLint drawFramebuffer, viewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    m_yuv.bind();
+
+    gl::StateCache& state = gl::StateCache::get();
+    state.setEnabled(GL_DEPTH_TEST, false);
+    state.bindTexture(0, GL_TEXTURE_2D, texture);
+
+    m_shader.Bind();
+    m_VAO.Bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    m_VAO.Unbind();
+    m_shader.Unbind();
+
+    state.setEnabled(GL_DEPTH_TEST, true);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_yuv.fbo);
+    m_capture.capture(m_yuv.width, m_yuv.height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, drawFramebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void VideoEncoder::finish()
+{
+    m_capture.finish();
+}
+
+bool VideoEncoder::validSize(int width, int height)
+{
+    return width >= 8 && height >= 2 && width % 8 == 0 && height % 2 == 0;
+}
@@ -0,0 +1,45 @@
+#ifndef VIDEOENCODER_H
+#define VIDEOENCODER_H
+
+#include <string>
+
+#include "gl/glObjects.h"
+#include "frameCapture.h"
+
+/*
+    Streams rendered frames into a YUV4MPEG2 (.y4m) file, 4:2:0 with BT.709 limited
+    range. The RGB to YUV conversion and the plane layout are done in a shader pass
+    (rgbToYuv), so only 1.5 bytes per pixel are read back and the writer thread
+    just appends them to the file. Readbacks go through FrameCapture and never
+    stall the render loop.
+
+    The width has to be a multiple of 8 and the height even.
+*/
+class VideoEncoder
+{
+public:
+    VideoEncoder(const std::string& path, int width, int height, int fps);
+    ~VideoEncoder();
+
+    // Converts the rendered frame in texture (width x height) and queues it for writing
+    void encode(GLuint texture);
+
+    // Writes every queued frame and closes the file
+    void finish();
+
+    static bool validSize(int width, int height);
+
+private:
+    int m_width;
+    int m_height;
+
+    gl::Framebuffer m_yuv;
+    gl::VertexArray m_VAO;
+    gl::Shader      m_shader;
+    FrameCapture    m_capture;
+
+    // Uniform handles of m_shader
+    enum Uniform { U_SOURCE, U_SIZE, U_COUNT };
+};
+
+#endif
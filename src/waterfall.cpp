@@ -0,0 +1,111 @@
+#include "waterfall.h"
+
+#ifdef _WIN32
+#include <SDL.h>
+#elif __linux__
+#include <SDL2/SDL.h>
+#endif
+#include <cstdio>
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "frameUniforms.h"
+#include "palette.h"
+
+Waterfall::Waterfall(const nlohmann::json& config)
+    : m_history(std::max(2, config.value("rows", 256)))
+{
+    const glm::vec3 position = vec3Config(config, "position", { 40.0f, 0.0f, 0.0f });
+    const float yaw = config.value("yaw", 90.0f);
+
+    m_size  = vec3Config(config, "size", { 60.0f, 100.0f, 120.0f });
+    m_model = glm::translate(glm::mat4(1.0f), position);
+    m_model = glm::rotate(m_model, glm::radians(yaw), glm::vec3(0, 1, 0));
+
+    // Get basepath for the assets folder
+    char* basePath = SDL_GetBasePath();
+    std::string shaderPath = basePath + std::string("assets/shaders/");
+    SDL_free(basePath);
+
+    m_shader.setAttribute(0, "position");
+    m_shader.createProgram(shaderPath + "waterfall");
+
+    static const char* const uniforms[U_COUNT] = { "history", "palette", "paletteMapping", "head", "model", "size" };
+    m_shader.resolveUniforms(uniforms);
+
+    m_shader.bindUniformBlock("Frame", FrameUniforms::BINDING);
+    m_shader.Bind();
+    glUniform1i(m_shader.uniform(U_HISTORY), 0);
+    glUniform1i(m_shader.uniform(U_PALETTE), 1);
+    m_shader.loadMatrix(m_shader.uniform(U_MODEL), m_model);
+    m_shader.loadVector3(m_shader.uniform(U_SIZE), m_size);
+    m_shader.Unbind();
+
+    buildGrid(std::max(2, config.value("columns", 256)), m_history.rows);
+}
+
+glm::vec3 Waterfall::vec3Config(const nlohmann::json& config, const char* key, glm::vec3 fallback)
+{
+    const std::vector<float> values = config.value(key, std::vector<float>{ fallback.x, fallback.y, fallback.z });
+    if (values.size() < 3)
+    {
+        printf("visualiser3d.waterfall.%s needs 3 values, using the default\n", key);
+        return fallback;
+    }
+    return { values[0], values[1], values[2] };
+}
+
+// Static grid of (u, v) in [0, 1], u across the spectrum, v = age (0 is the newest row)
+void Waterfall::buildGrid(int columns, int rows)
+{
+    std::vector<GLfloat> vertices;
+    vertices.reserve((size_t)columns * rows * 2);
+    for (int z = 0; z < rows; z++)
+    {
+        for (int x = 0; x < columns; x++)
+        {
+            vertices.push_back(x / (float)(columns - 1));
+            vertices.push_back(z / (float)(rows - 1));
+        }
+    }
+
+    std::vector<GLuint> indices;
+    indices.reserve((size_t)(columns - 1) * (rows - 1) * 6);
+    for (int z = 0; z < rows - 1; z++)
+    {
+        for (int x = 0; x < columns - 1; x++)
+        {
+            GLuint i = z * columns + x;
+            indices.insert(indices.end(), { i, i + columns, i + 1, i + 1, i + columns, i + columns + 1 });
+        }
+    }
+
+    m_VAO.Bind();
+    m_gridVBO.setData(vertices, 0, 2);
+    m_gridEBO.setData(indices);
+    m_VAO.Unbind();
+}
+
+void Waterfall::update(const std::vector<float>& magnitudes)
+{
+    m_history.pushLine(magnitudes.data(), (int)magnitudes.size());
+}
+
+void Waterfall::Draw(Palette& palette)
+{
+    if (m_history.width == 0)
+        return;
+
+    m_shader.Bind();
+    glUniform1i(m_shader.uniform(U_HEAD), m_history.head);
+    m_shader.loadVector3(m_shader.uniform(U_PALETTE_MAPPING), palette.getMapping());
+
+    m_history.bind(0);
+    palette.bind(1);
+
+    m_VAO.Bind();
+    glDrawElements(GL_TRIANGLES, m_gridEBO.size, GL_UNSIGNED_INT, 0);
+    m_VAO.Unbind();
+
+    m_shader.Unbind();
+}
@@ -0,0 +1,54 @@
+#ifndef WATERFALL_H
+#define WATERFALL_H
+
+#include <vector>
+
+#include "gl/glObjects.h"
+#include "libs/json.hpp"
+
+class Palette;
+
+/*
+    Spectrogram terrain of the last N analysis frames. Every update writes one row
+    (the new spectrum) into a ring buffered height texture, a static grid mesh reads it
+    in the vertex shader starting at the newest row, so the terrain scrolls without
+    re-uploading the history and the per frame cost is one spectrum regardless of N.
+
+    Config (visualiser3d.waterfall):
+        "rows":     256              history length in analysis frames
+        "columns":  256              grid vertices across the spectrum
+        "size":     [w, h, d]        world size, h scales the magnitudes
+        "position": [x, y, z]        centre of the terrain base
+        "yaw":      90               rotation around y (degrees), the newest row faces -z before it
+*/
+class Waterfall
+{
+public:
+    Waterfall(const nlohmann::json& config);
+
+    // Adds this frame's magnitudes as the newest row
+    void update(const std::vector<float>& magnitudes);
+
+    // Colour by palette index = position across the spectrum, magnitude = height
+    void Draw(Palette& palette);
+
+private:
+    gl::RingTexture2D m_history;
+
+    gl::VertexArray        m_VAO;
+    gl::VertexBufferObject m_gridVBO;
+    gl::ElementArrayBuffer m_gridEBO;
+    gl::Shader             m_shader;
+
+    // Uniform handles of m_shader
+    enum Uniform { U_HISTORY, U_PALETTE, U_PALETTE_MAPPING, U_HEAD, U_MODEL, U_SIZE, U_COUNT };
+
+    glm::mat4 m_model;
+    glm::vec3 m_size;
+
+    void buildGrid(int columns, int rows);
+    // x, y and z of a config array, fallback when it is missing or too short
+    static glm::vec3 vec3Config(const nlohmann::json& config, const char* key, glm::vec3 fallback);
+};
+
+#endif